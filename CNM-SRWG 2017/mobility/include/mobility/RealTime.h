@@ -0,0 +1,34 @@
+#ifndef MOBILITY_REALTIME_H
+#define MOBILITY_REALTIME_H
+
+#include <string>
+
+/**
+ * Opt-in real time scheduling for the threads that drive the rover.
+ *
+ * A node calls lockProcessMemory() once, then makeThreadRealTime() from each
+ * control critical thread (it only ever changes the thread it is called
+ * on), so threads started before or without it - camera, logging, ROS
+ * networking - keep normal priority.  Needs CAP_SYS_NICE/CAP_IPC_LOCK (or
+ * matching rtprio/memlock limits); without them the calls fail and say why,
+ * and the node carries on as before.
+ */
+
+static const unsigned int PREFAULT_STACK = 256 * 1024;
+
+struct RealTimeConfig {
+    RealTimeConfig() : priority(50), cpu(-1) {}
+
+    int priority;                           // SCHED_FIFO, 1 (lowest) - 99
+    int cpu;                                // core to pin to, -1 leaves it to the scheduler
+};
+
+// mlockall, current and future pages.  False (and why in error) on failure.
+bool lockProcessMemory(std::string& error);
+
+// SCHED_FIFO at config.priority, pinned to config.cpu, and the first
+// PREFAULT_STACK bytes of stack touched so the loop never page faults on it.
+// Stops at the first thing that fails.
+bool makeThreadRealTime(const RealTimeConfig& config, std::string& error);
+
+#endif // MOBILITY_REALTIME_H
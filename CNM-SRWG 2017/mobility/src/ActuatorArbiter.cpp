@@ -0,0 +1,73 @@
+#include "ActuatorArbiter.h"
+
+ActuatorArbiter::ActuatorArbiter()
+{
+    dropped = 0;
+}
+
+void ActuatorArbiter::requestDrive(ActuatorPriority priority, double linear, double angular)
+{
+    DriveCommand command;
+    command.linear = linear;
+    command.angular = angular;
+
+    drive.request(priority, command);
+}
+
+void ActuatorArbiter::requestFinger(ActuatorPriority priority, float angle)
+{
+    finger.request(priority, angle);
+}
+
+void ActuatorArbiter::requestWrist(ActuatorPriority priority, float angle)
+{
+    wrist.request(priority, angle);
+}
+
+template <typename T>
+bool ActuatorArbiter::resolveChannel(Channel<T>& channel, T& value, bool onlyChanges)
+{
+    if (!channel.pending) { return false; }
+
+    channel.pending = false;
+
+    if (channel.claimed && channel.pendingPriority < channel.cyclePriority)
+    {
+        dropped++;
+        return false;
+    }
+
+    channel.claimed = true;
+    channel.cyclePriority = channel.pendingPriority;
+
+    //unchanged gripper angle, the last one is still latched on the topic
+    if (onlyChanges && channel.sent && channel.lastValue == channel.pendingValue) { return false; }
+
+    channel.sent = true;
+    channel.lastValue = channel.pendingValue;
+    value = channel.pendingValue;
+
+    return true;
+}
+
+void ActuatorArbiter::resolve(std::vector<DriveCommand>& driveCommands, std::vector<float>& fingerAngles, std::vector<float>& wristAngles)
+{
+    DriveCommand command;
+    if (resolveChannel(drive, command, false)) { driveCommands.push_back(command); }
+
+    float angle;
+    if (resolveChannel(finger, angle, true)) { fingerAngles.push_back(angle); }
+    if (resolveChannel(wrist, angle, true)) { wristAngles.push_back(angle); }
+}
+
+bool ActuatorArbiter::mayDrive(ActuatorPriority priority) const
+{
+    return !drive.claimed || priority >= drive.cyclePriority;
+}
+
+void ActuatorArbiter::endCycle()
+{
+    drive.claimed = false;
+    finger.claimed = false;
+    wrist.claimed = false;
+}
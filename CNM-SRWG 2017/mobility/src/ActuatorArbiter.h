@@ -0,0 +1,86 @@
+#ifndef ACTUATORARBITER_H
+#define ACTUATORARBITER_H
+
+#include <vector>
+#include <stdint.h>
+
+#include "GoalTracker.h"
+
+// Who is asking for the actuators, lowest first.  A higher priority request
+// always beats a lower one.
+enum ActuatorPriority {
+    PRIORITY_SEARCH = 0,
+    PRIORITY_DROPOFF,
+    PRIORITY_PICKUP,
+    PRIORITY_OBSTACLE,
+    PRIORITY_MANUAL,                        // operator/e-stop, joystick and mode changes
+    PRIORITY_LEVELS
+};
+
+/**
+ * Collects the drive and gripper requests made while the core handles one
+ * step and decides what actually goes out:
+ *  - at most one drive, finger and wrist command per step, the highest
+ *    priority request (the last one if several share that priority)
+ *  - within a cycle (one state machine tick to the next) a request is dropped
+ *    if something of higher priority already went out, so obstacle avoidance
+ *    isn't undone by the search code a few milliseconds later
+ *  - finger and wrist angles only go out when they change
+ */
+class ActuatorArbiter
+{
+public:
+    ActuatorArbiter();
+
+    void requestDrive(ActuatorPriority priority, double linear, double angular);
+    void requestFinger(ActuatorPriority priority, float angle);
+    void requestWrist(ActuatorPriority priority, float angle);
+
+    // Hands the winners of this step out and clears the requests
+    void resolve(std::vector<DriveCommand>& drive, std::vector<float>& fingerAngles, std::vector<float>& wristAngles);
+
+    // Would a drive request at this priority win right now
+    bool mayDrive(ActuatorPriority priority) const;
+
+    // Call once per state machine tick, after resolve()
+    void endCycle();
+
+    uint64_t getDroppedCount() const { return dropped; }
+
+private:
+    template <typename T>
+    struct Channel {
+        Channel() : pending(false), pendingPriority(0), claimed(false), cyclePriority(0), sent(false) {}
+
+        void request(int priority, const T& value)
+        {
+            if (pending && priority < pendingPriority) { return; }
+
+            pending = true;
+            pendingPriority = priority;
+            pendingValue = value;
+        }
+
+        bool pending;
+        int pendingPriority;
+        T pendingValue;
+
+        bool claimed;                       // something went out this cycle
+        int cyclePriority;                  // highest priority that went out this cycle
+
+        bool sent;                          // lastValue is valid
+        T lastValue;
+    };
+
+    // Returns true and fills value if the pending request wins
+    template <typename T>
+    bool resolveChannel(Channel<T>& channel, T& value, bool onlyChanges);
+
+    Channel<DriveCommand> drive;
+    Channel<float> finger;
+    Channel<float> wrist;
+
+    uint64_t dropped;                       // requests that lost to a higher priority
+};
+
+#endif // ACTUATORARBITER_H
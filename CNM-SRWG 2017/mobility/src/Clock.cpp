@@ -0,0 +1,16 @@
+#include "Clock.h"
+
+#include <chrono>
+
+using namespace std;
+
+int64_t SteadyClock::nanoseconds() const
+{
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const SteadyClock& SteadyClock::instance()
+{
+    static SteadyClock clock;
+    return clock;
+}
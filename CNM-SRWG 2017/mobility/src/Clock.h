@@ -0,0 +1,52 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * The one place controllers get the time from.  Nanoseconds from some epoch
+ * the clock chooses, only differences between two readings mean anything.
+ *
+ *  - StepClock    whatever it was last set to.  MobilityCore sets it from
+ *                 MobilityInput::time every step, so under the node it
+ *                 follows ros::Time (sim time in Gazebo) and under
+ *                 mobility_replay it follows the log.
+ *  - SteadyClock  the monotonic clock, for code with no one to set a StepClock
+ *  - RosClock     (RosClock.h, node only) ros::Time::now()
+ */
+class Clock
+{
+public:
+    virtual ~Clock() {}
+
+    virtual int64_t nanoseconds() const = 0;
+
+    double seconds() const { return nanoseconds() * 1e-9; }
+};
+
+class StepClock : public Clock
+{
+public:
+    StepClock() : current(0) {}
+
+    // set from one thread, read from any
+    void set(int64_t nanoseconds) { current.store(nanoseconds, std::memory_order_relaxed); }
+    void setSeconds(double seconds) { set((int64_t)(seconds * 1e9 + (seconds < 0 ? -0.5 : 0.5))); }
+
+    virtual int64_t nanoseconds() const { return current.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> current;
+};
+
+class SteadyClock : public Clock
+{
+public:
+    virtual int64_t nanoseconds() const;
+
+    // shared default for anything not handed a clock
+    static const SteadyClock& instance();
+};
+
+#endif // CLOCK_H
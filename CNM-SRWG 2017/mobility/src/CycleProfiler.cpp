@@ -0,0 +1,139 @@
+#include "CycleProfiler.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+static const char* phaseNames[] = { "searching", "approach", "grasp", "return", "centering", "drop", "recovery", "obstacle" };
+
+const char* cyclePhaseName(int phase)
+{
+    if (phase == CYCLE_PHASES) { return "cycle"; }
+    if (phase < 0 || phase > CYCLE_PHASES) { return "none"; }
+
+    return phaseNames[phase];
+}
+
+double CycleRecord::total() const
+{
+    double sum = 0;
+    for (int i = 0; i < CYCLE_PHASES; i++) { sum += phaseSeconds[i]; }
+
+    return sum;
+}
+
+//PROFILER
+//---------------------------------------------
+
+CycleProfiler::CycleProfiler()
+{
+    memset(&current, 0, sizeof(current));
+    memset(&finished, 0, sizeof(finished));
+    lastPhase = -1;
+    lastTime = 0;
+    started = false;
+}
+
+void CycleProfiler::begin(double now)
+{
+    int number = current.number + 1;
+
+    memset(&current, 0, sizeof(current));
+    current.number = number;
+    current.start = now;
+}
+
+void CycleProfiler::update(double now, int phase)
+{
+    //the first cycle starts the first time we are autonomous
+    if (!started)
+    {
+        if (phase < 0) { return; }
+
+        begin(now);
+        lastTime = now;
+        started = true;
+    }
+
+    if (lastPhase >= 0) { current.phaseSeconds[lastPhase] += now - lastTime; }
+
+    if (phase >= 0 && phase != lastPhase)
+    {
+        CycleSegment* last = current.segmentCount > 0 ? &current.segments[current.segmentCount - 1] : 0;
+
+        //a phase left in the same step it was entered in never happened
+        if (last && last->start == now - current.start) { last->phase = phase; }
+        else if (current.segmentCount < CycleRecord::MAX_SEGMENTS)
+        {
+            CycleSegment& segment = current.segments[current.segmentCount++];
+            segment.phase = phase;
+            segment.start = now - current.start;
+        }
+    }
+
+    lastPhase = phase;
+    lastTime = now;
+}
+
+const CycleRecord& CycleProfiler::complete(double now)
+{
+    update(now, lastPhase);
+
+    finished = current;
+    finished.end = now;
+
+    begin(now);
+
+    //carry on in the same phase, recorded as the first segment of the new cycle
+    int phase = lastPhase;
+    lastPhase = -1;
+    update(now, phase);
+
+    return finished;
+}
+
+//ROLLING STATS
+//---------------------------------------------
+
+CycleStats::CycleStats(unsigned int window)
+{
+    this->window = window;
+    next = 0;
+}
+
+void CycleStats::add(const CycleRecord& record)
+{
+    if (records.size() < window) { records.push_back(record); }
+    else { records[next] = record; }
+
+    next = (next + 1) % window;
+}
+
+double CycleStats::value(const CycleRecord& record, int phase) const
+{
+    return phase == CYCLE_PHASES ? record.total() : record.phaseSeconds[phase];
+}
+
+double CycleStats::mean(int phase) const
+{
+    if (records.empty()) { return 0; }
+
+    double sum = 0;
+    for (unsigned int i = 0; i < records.size(); i++) { sum += value(records[i], phase); }
+
+    return sum / records.size();
+}
+
+double CycleStats::percentile(int phase, double fraction) const
+{
+    if (records.empty()) { return 0; }
+
+    vector<double> values;
+    for (unsigned int i = 0; i < records.size(); i++) { values.push_back(value(records[i], phase)); }
+
+    sort(values.begin(), values.end());
+
+    unsigned int index = (unsigned int)(fraction * (values.size() - 1) + 0.5);
+    return values[index];
+}
@@ -0,0 +1,90 @@
+#ifndef CYCLEPROFILER_H
+#define CYCLEPROFILER_H
+
+#include <vector>
+
+/**
+ * Splits every collection cycle (one target from the end of the last drop
+ * to the end of this one) into the phases below and times them, so we can
+ * see which part of a delivery the minutes go into.
+ *
+ * MobilityCore tells the profiler which phase it is in after every step;
+ * the time up to the next update is charged to that phase.  Time outside
+ * autonomous mode (phase -1) isn't charged to anything.
+ */
+
+enum CyclePhase {
+    PHASE_SEARCHING,                        // no target, looking
+    PHASE_APPROACH,                         // PICKUP, driving up to a target
+    PHASE_GRASP,                            // PICKUP with the target locked
+    PHASE_RETURN,                           // carrying, heading for the nest
+    PHASE_CENTERING,                        // carrying, squaring up on the nest
+    PHASE_DROP,                             // driving in and dropping
+    PHASE_RECOVERY,                         // backing up/turning 180
+    PHASE_OBSTACLE,                         // stopped for or avoiding an obstacle
+    CYCLE_PHASES
+};
+
+const char* cyclePhaseName(int phase);
+
+struct CycleSegment {
+    int phase;
+    double start;                           // seconds into the cycle
+};
+
+struct CycleRecord {
+    static const int MAX_SEGMENTS = 32;     // a busier cycle folds the rest into the last segment
+
+    int number;                             // 1 for the first delivery
+    double start;                           // core time
+    double end;
+    double phaseSeconds[CYCLE_PHASES];
+
+    int segmentCount;
+    CycleSegment segments[MAX_SEGMENTS];    // every phase change, in order
+
+    double total() const;
+};
+
+class CycleProfiler
+{
+public:
+    CycleProfiler();
+
+    // phase is a CyclePhase, or -1 while not autonomous
+    void update(double now, int phase);
+
+    // Ends the running cycle (a target was dropped) and starts the next one
+    const CycleRecord& complete(double now);
+
+private:
+    void begin(double now);
+
+    CycleRecord current;
+    CycleRecord finished;
+    int lastPhase;
+    double lastTime;
+    bool started;
+};
+
+// Rolling mean/p50/p95 of each phase over the last window cycles
+class CycleStats
+{
+public:
+    CycleStats(unsigned int window);
+
+    void add(const CycleRecord& record);
+
+    unsigned int count() const { return records.size(); }
+    double mean(int phase) const;           // phase CYCLE_PHASES for the whole cycle
+    double percentile(int phase, double fraction) const;
+
+private:
+    double value(const CycleRecord& record, int phase) const;
+
+    unsigned int window;
+    std::vector<CycleRecord> records;
+    unsigned int next;
+};
+
+#endif // CYCLEPROFILER_H
@@ -5,6 +5,8 @@ SearchController DropOffSearch;
 
 DropOffController::DropOffController()
 {
+    clock = &SteadyClock::instance();
+
     cameraOffsetCorrection = 0.020; //meters
     centeringTurn = 0.15; //radians
     seenEnoughCenterTagsCount = 13;
@@ -28,10 +30,10 @@ DropOffController::DropOffController()
     circularCenterSearching = false;
     spinner = 0;
     centerApproach = false;
-    timeWithoutSeeingEnoughCenterTags = time(0);
+    timeWithoutSeeingEnoughCenterTags = clock->seconds();
     seenEnoughCenterTags = false;
     centerSeen = false;
-    timeElapsedSinceTimeSinceSeeingEnoughCenterTags = time(0);
+    timeElapsedSinceTimeSinceSeeingEnoughCenterTags = 0;
     circularCenterSearching = false;
     prevCount = 0;
 
@@ -125,7 +127,7 @@ void DropOffController::calculateDecision() {
 
 
     //reset timeWithoutSeeingEnoughCenterTags timout timer to current time
-    if ((!centerApproach && !seenEnoughCenterTags) || (count > 0 && !seenEnoughCenterTags)) timeWithoutSeeingEnoughCenterTags = time(0);
+    if ((!centerApproach && !seenEnoughCenterTags) || (count > 0 && !seenEnoughCenterTags)) timeWithoutSeeingEnoughCenterTags = clock->seconds();
 
     if (count > 0 || seenEnoughCenterTags || prevCount > 0) //if we have a target and the center is located drive towards it.
     {
@@ -173,14 +175,14 @@ void DropOffController::calculateDecision() {
         if (count > seenEnoughCenterTagsCount)
         {
             seenEnoughCenterTags = true; //we have driven far enough forward to be in the circle.
-            timeWithoutSeeingEnoughCenterTags = time(0);
+            timeWithoutSeeingEnoughCenterTags = clock->seconds();
         }
         if (count > 0) //reset gaurd to prevent drop offs due to loosing tracking on tags for a frame or 2.
         {
-            timeWithoutSeeingEnoughCenterTags = time(0);
+            timeWithoutSeeingEnoughCenterTags = clock->seconds();
         }
         //time since we dropped below countGuard tags
-        timeElapsedSinceTimeSinceSeeingEnoughCenterTags = time(0) - timeWithoutSeeingEnoughCenterTags;
+        timeElapsedSinceTimeSinceSeeingEnoughCenterTags = clock->seconds() - timeWithoutSeeingEnoughCenterTags;
 
         //we have driven far enough forward to have passed over the circle.
         if (count == 0 && seenEnoughCenterTags && timeElapsedSinceTimeSinceSeeingEnoughCenterTags > 1) {
@@ -197,7 +199,7 @@ void DropOffController::calculateDecision() {
         result.goalDriving = false;
         int maxTimeAllowedWithoutSeeingCenterTags = 6; //seconds
 
-        timeElapsedSinceTimeSinceSeeingEnoughCenterTags = time(0) - timeWithoutSeeingEnoughCenterTags;
+        timeElapsedSinceTimeSinceSeeingEnoughCenterTags = clock->seconds() - timeWithoutSeeingEnoughCenterTags;
         if (timeElapsedSinceTimeSinceSeeingEnoughCenterTags > maxTimeAllowedWithoutSeeingCenterTags)
         {
             //go back to drive to center base location instead of drop off attempt
@@ -222,7 +224,7 @@ void DropOffController::calculateDecision() {
     if (!centerSeen && seenEnoughCenterTags)
     {
         reachedCollectionPoint = true;
-        timerStartTime = time(0);
+        timerStartTime = clock->seconds();
         result.goalDriving = false;
         centerApproach = false;
         result.timer = true;
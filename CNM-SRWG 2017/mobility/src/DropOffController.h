@@ -5,6 +5,7 @@
 #include <geometry_msgs/Pose2D.h>
 #include <std_msgs/Float32.h>
 #include "SearchController.h"
+#include "Clock.h"
 
 struct DropOffResult {
     float cmdVel;
@@ -36,6 +37,13 @@ public:
     void setCenterDist(float dist) {distanceToCenter = dist;}
     void setDataLocations(geometry_msgs::Pose2D center, geometry_msgs::Pose2D current, float sync);
 
+    //time comes from clock (the SteadyClock until told otherwise)
+    void setClock(const Clock* clock)
+    {
+        this->clock = clock;
+        timeWithoutSeeingEnoughCenterTags = clock->seconds();
+    }
+
     //void setSearch(SearchController *cont) { DropOffSearch = cont; }
 
     bool cnmInPosition;
@@ -61,7 +69,7 @@ private:
     //central collection point has been seen (aka the nest)
     bool centerSeen;
 
-    time_t timeWithoutSeeingEnoughCenterTags;
+    double timeWithoutSeeingEnoughCenterTags;       //seconds, on clock
     float cameraOffsetCorrection;
     float centeringTurn;
     int seenEnoughCenterTagsCount;
@@ -75,7 +83,7 @@ private:
     geometry_msgs::Pose2D centerLocation;
     geometry_msgs::Pose2D currentLocation;
     float timerTimeElapsed;
-    time_t timerStartTime;
+    double timerStartTime;
     float timeElapsedSinceTimeSinceSeeingEnoughCenterTags;
     float spinSize;
     float addSpinSize;
@@ -85,6 +93,8 @@ private:
 
     float searchVelocity;
 
+    const Clock* clock;
+
     void calculateDecision();
 
 };
@@ -0,0 +1,437 @@
+#include "EventLog.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+using namespace std;
+
+static const char eventLogMagic[8] = { 'M', 'O', 'B', 'E', 'V', 'T', '1', '\n' };
+static const uint32_t eventLogVersion = 1;
+
+//EVENT CATALOGUE
+//---------------------------------------------
+//each {} in the text is replaced by the next field, printed as an integer
+//(i) or a decimal (f)
+struct EventDef {
+    int id;
+    const char* text;
+    const char* fields;
+};
+
+constexpr EventDef eventDefs[] = {
+    { EVENT_LOG_DROPPED,            "Event log full, dropped {} events from thread {}", "ii" },
+    { EVENT_LOG_STARTED,            "Log Started", "" },
+    { EVENT_RECORDING_INPUTS,       "Recording mobility inputs to ~record_inputs", "" },
+    { EVENT_RECORDING_FAILED,       "Could not open ~record_inputs for recording mobility inputs", "" },
+    { EVENT_TRANSFORM_STALE,        "mapAverage(): map to odom transform unavailable (age {}s), keeping last center", "f" },
+    { EVENT_START_DELAY,            "Rover start delay set to {} seconds", "f" },
+    { EVENT_AUTONOMOUS_FIRST_BOOT,  "Switched to AUTONOMOUS; Waiting For Find Center Protocol", "" },
+    { EVENT_CENTER_TAG_SEEN,        "Seen A Center Tag", "" },
+    { EVENT_NO_STATE,               "Oops I got here", "" },
+    { EVENT_TRAVELING,              "Traveling to point {} in pattern:  {}", "if" },
+    { EVENT_SEARCH_EXPANDING,       "Search Pattern Expanding", "" },
+    { EVENT_NEST_FOUND,             "Found Initial Nest Location", "" },
+    { EVENT_NEST_REFOUND,           "Refound center, updating location", "" },
+    { EVENT_NEST_LOST,              "Where am I? I don't see the Nest! Better Look!", "" },
+    { EVENT_CENTER_AVERAGING,       "Averaging Center Location", "" },
+    { EVENT_CENTER_REJECTED,        "Rejected center point {}, {} ({} sd off)", "fff" },
+    { EVENT_CENTER_DISAGREE,        "Center points disagree (std err {}), not averaging", "f" },
+    { EVENT_DROP_FOUND_CENTER,      "Found center; Dropping Off", "" },
+    { EVENT_DROP_SQUARED_UP,        "Squared up; Driving forward", "" },
+    { EVENT_DROP_TOO_MANY_TAGS,     "Tags greater than 8", "" },
+    { EVENT_DROP_SOME_TAGS,         "Tags between 3 and 8", "" },
+    { EVENT_DROP_TURN_LEFT,         "Turning Left:  {} > {}", "ii" },
+    { EVENT_DROP_TURN_RIGHT,        "Turning Right:  {} < {}", "ii" },
+    { EVENT_DROP_TAGS_EVEN,         "Tag Count is even {} = {}", "ii" },
+    { EVENT_DROP_FEW_TAGS,          "Tags less than 3; Dropping off!", "" },
+    { EVENT_DROP_MORE_TAGS,         "See More Tags, dropping here!", "" },
+    { EVENT_OBSTACLE_WAITING,       "Continuing To Wait ({} in a row)", "i" },
+    { EVENT_OBSTACLE_AVOIDING,      "Obstacle Avoidance Initiated", "" },
+    { EVENT_AVOID_TARGETS_DONE,     "Finished avoid timer, trying to return to center", "" },
+    { EVENT_FLIGHT_DUMP,            "Flight recorder dump {} written (last {} s)", "if" },
+    { EVENT_PICKUP_GAVE_UP,         "Gave up picking up target", "" },
+    { EVENT_CYCLE_COMPLETE,         "Delivery {} took {} s", "if" },
+    { EVENT_CONTROL_STALLED,        "Control loop stalled for {} s, stopping the rover", "f" },
+    { EVENT_CONTROL_RESUMED,        "Control loop running again", "" },
+    { EVENT_ODOMETRY_STALE,         "No odometry for {} s, holding still", "f" },
+    { EVENT_ODOMETRY_FRESH,         "Odometry back", "" },
+    { EVENT_MAP_STALE,              "No map pose for {} s, not averaging it", "f" },
+    { EVENT_MAP_FRESH,              "Map pose back", "" },
+    { EVENT_OBSTACLE_STALE,         "No obstacle reading for {} s", "f" },
+    { EVENT_OBSTACLE_FRESH,         "Obstacle readings back", "" },
+    { EVENT_TARGETS_STALE,          "No camera frame for {} s, forgetting the tags in view", "f" },
+    { EVENT_TARGETS_FRESH,          "Camera frames back", "" },
+    { EVENT_NEST_FITTED,            "Nest fitted at {}, {} (residual {}), not squaring up", "fff" },
+    { EVENT_CENTER_RESTARTED,       "Center points keep disagreeing, starting over at {}, {}", "ff" }
+};
+
+namespace event_check
+{
+    constexpr int length(const char* s) { return *s ? 1 + length(s + 1) : 0; }
+
+    constexpr bool rowsValid(const EventDef* defs, int n, int i)
+    {
+        return i == n || (defs[i].id == i && length(defs[i].fields) <= EVENT_FIELDS && rowsValid(defs, n, i + 1));
+    }
+}
+
+static_assert(sizeof(eventDefs) / sizeof(eventDefs[0]) == EVENT_IDS, "eventDefs needs a row for every EventId");
+static_assert(event_check::rowsValid(eventDefs, EVENT_IDS, 0), "eventDefs: ids must match rows and use at most EVENT_FIELDS fields");
+
+Event makeEvent(double time, EventId id, double a, double b, double c)
+{
+    Event event;
+    event.time = time;
+    event.id = id;
+    event.source = 0;
+    event.fieldCount = strlen(eventDefs[id].fields);
+    event.fields[0] = a;
+    event.fields[1] = b;
+    event.fields[2] = c;
+
+    return event;
+}
+
+string formatEvent(const Event& event)
+{
+    if (event.id >= EVENT_IDS)
+    {
+        stringstream ss;
+        ss << "Unknown event " << event.id;
+        return ss.str();
+    }
+
+    const EventDef& def = eventDefs[event.id];
+
+    stringstream ss;
+    int field = 0;
+
+    for (const char* c = def.text; *c; c++)
+    {
+        if (c[0] == '{' && c[1] == '}' && field < event.fieldCount && def.fields[field])
+        {
+            if (def.fields[field] == 'i') { ss << (long long)llround(event.fields[field]); }
+            else { ss << event.fields[field]; }
+
+            field++;
+            c++;
+        }
+        else
+        {
+            ss << *c;
+        }
+    }
+
+    return ss.str();
+}
+
+static double steadySeconds()
+{
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//RING
+//---------------------------------------------
+
+EventRing::EventRing(uint8_t source, unsigned int capacity) : head(0), tail(0), dropped(0)
+{
+    this->source = source;
+
+    unsigned int size = 1;
+    while (size < capacity) { size <<= 1; }
+
+    events.resize(size);
+    mask = size - 1;
+}
+
+bool EventRing::push(const Event& event)
+{
+    unsigned int h = head.load(memory_order_relaxed);
+
+    if (h - tail.load(memory_order_acquire) > mask)
+    {
+        dropped.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+
+    events[h & mask] = event;
+    events[h & mask].source = source;
+
+    head.store(h + 1, memory_order_release);
+    return true;
+}
+
+bool EventRing::pop(Event& event)
+{
+    unsigned int t = tail.load(memory_order_relaxed);
+    if (t == head.load(memory_order_acquire)) { return false; }
+
+    event = events[t & mask];
+
+    tail.store(t + 1, memory_order_release);
+    return true;
+}
+
+//WRITER
+//---------------------------------------------
+
+EventLog::EventLog() : running(false)
+{
+    file = NULL;
+    textRate = 5;
+    repeatWindow = 2;
+    tokens = 0;
+    lastRefill = 0;
+    hasLastText = false;
+    repeats = 0;
+    rateDropped = 0;
+    drainRate = 10;
+}
+
+EventLog::~EventLog()
+{
+    stop();
+
+    for (unsigned int i = 0; i < rings.size(); i++) { delete rings[i]; }
+}
+
+EventRing* EventLog::createRing(unsigned int capacity)
+{
+    EventRing* ring = new EventRing(rings.size(), capacity);
+    rings.push_back(ring);
+
+    return ring;
+}
+
+bool EventLog::open(const string& path)
+{
+    file = fopen(path.c_str(), "wb");
+    if (!file) { return false; }
+
+    uint32_t reserved = 0;
+    fwrite(eventLogMagic, sizeof(eventLogMagic), 1, file);
+    fwrite(&eventLogVersion, sizeof(eventLogVersion), 1, file);
+    fwrite(&reserved, sizeof(reserved), 1, file);
+
+    return true;
+}
+
+void EventLog::setTextSink(const TextSink& sink, double textRate, double repeatWindow)
+{
+    this->sink = sink;
+    this->textRate = textRate;
+    this->repeatWindow = repeatWindow;
+    tokens = textRate;
+}
+
+void EventLog::start(double drainRate)
+{
+    if (running) { return; }
+
+    this->drainRate = drainRate;
+    lastRefill = steadySeconds();
+
+    running = true;
+    worker = thread(&EventLog::writeLoop, this);
+}
+
+void EventLog::stop()
+{
+    if (running)
+    {
+        running = false;
+        worker.join();
+    }
+
+    //whatever came in after the last drain
+    drain();
+    flushRepeats();
+
+    if (file)
+    {
+        fclose(file);
+        file = NULL;
+    }
+}
+
+void EventLog::writeLoop()
+{
+    chrono::duration<double> period(1.0 / drainRate);
+
+    while (running)
+    {
+        this_thread::sleep_for(period);
+        drain();
+    }
+}
+
+void EventLog::drain()
+{
+    double now = steadySeconds();
+    tokens += (now - lastRefill) * textRate;
+    if (tokens > textRate) { tokens = textRate; }
+    lastRefill = now;
+
+    //an overflow is stamped with the time of the last event that made it
+    Event event;
+    event.time = 0;
+
+    for (unsigned int i = 0; i < rings.size(); i++)
+    {
+        while (rings[i]->pop(event))
+        {
+            write(event);
+            text(event);
+        }
+
+        uint64_t dropped = rings[i]->takeDropped();
+        if (dropped > 0)
+        {
+            Event overflow = makeEvent(event.time, EVENT_LOG_DROPPED, dropped, rings[i]->getSource());
+            write(overflow);
+            text(overflow);
+        }
+    }
+
+    if (file) { fflush(file); }
+}
+
+void EventLog::write(const Event& event)
+{
+    if (!file) { return; }
+
+    fwrite(&event.time, sizeof(event.time), 1, file);
+    fwrite(&event.id, sizeof(event.id), 1, file);
+    fwrite(&event.source, sizeof(event.source), 1, file);
+    fwrite(&event.fieldCount, sizeof(event.fieldCount), 1, file);
+    fwrite(event.fields, sizeof(double), event.fieldCount, file);
+}
+
+void EventLog::text(const Event& event)
+{
+    if (!sink) { return; }
+
+    //the same event again (dropoff logs every tick) is only counted
+    if (hasLastText && event.id == lastText.id && event.time - lastText.time < repeatWindow &&
+        memcmp(event.fields, lastText.fields, sizeof(double) * event.fieldCount) == 0)
+    {
+        repeats++;
+        return;
+    }
+
+    flushRepeats();
+
+    sendText(formatEvent(event));
+
+    lastText = event;
+    hasLastText = true;
+}
+
+void EventLog::flushRepeats()
+{
+    if (repeats == 0) { return; }
+
+    stringstream ss;
+    ss << "last message repeated " << repeats << " times";
+    sendText(ss.str());
+
+    repeats = 0;
+}
+
+void EventLog::sendText(const string& line)
+{
+    if (tokens < 1)
+    {
+        rateDropped++;
+        return;
+    }
+
+    if (rateDropped > 0)
+    {
+        stringstream ss;
+        ss << rateDropped << " messages not shown (over " << textRate << "/s)";
+        rateDropped = 0;
+
+        tokens -= 1;
+        sink(ss.str());
+
+        if (tokens < 1)
+        {
+            rateDropped++;
+            return;
+        }
+    }
+
+    tokens -= 1;
+    sink(line);
+}
+
+//READER
+//---------------------------------------------
+
+EventLogReader::EventLogReader()
+{
+    file = NULL;
+}
+
+EventLogReader::~EventLogReader()
+{
+    close();
+}
+
+bool EventLogReader::open(const string& path)
+{
+    close();
+
+    file = fopen(path.c_str(), "rb");
+    if (!file) { return false; }
+
+    char magic[8];
+    uint32_t version, reserved;
+
+    if (fread(magic, sizeof(magic), 1, file) != 1 || fread(&version, sizeof(version), 1, file) != 1 ||
+        fread(&reserved, sizeof(reserved), 1, file) != 1 ||
+        memcmp(magic, eventLogMagic, sizeof(magic)) != 0 || version != eventLogVersion)
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void EventLogReader::close()
+{
+    if (file)
+    {
+        fclose(file);
+        file = NULL;
+    }
+}
+
+bool EventLogReader::next(Event& event)
+{
+    if (!file) { return false; }
+
+    memset(&event, 0, sizeof(event));
+
+    if (fread(&event.time, sizeof(event.time), 1, file) != 1 || fread(&event.id, sizeof(event.id), 1, file) != 1 ||
+        fread(&event.source, sizeof(event.source), 1, file) != 1 || fread(&event.fieldCount, sizeof(event.fieldCount), 1, file) != 1)
+    {
+        return false;
+    }
+
+    //a newer writer may log more fields than this build knows about
+    double extra;
+    for (int i = 0; i < event.fieldCount; i++)
+    {
+        double* field = i < EVENT_FIELDS ? &event.fields[i] : &extra;
+        if (fread(field, sizeof(double), 1, file) != 1) { return false; }
+    }
+
+    if (event.fieldCount > EVENT_FIELDS) { event.fieldCount = EVENT_FIELDS; }
+
+    return true;
+}
@@ -0,0 +1,185 @@
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Structured replacement for the infoLog strings.  An event is a numeric id
+ * plus up to EVENT_FIELDS numbers; the text that goes with each id (and how
+ * its fields are printed) lives in one table in EventLog.cpp, so logging an
+ * event is filling in a fixed size struct.  Nothing is formatted or
+ * allocated until someone reads the event.
+ *
+ * Each thread that logs gets its own EventRing (preallocated, single
+ * producer).  The EventLog writer thread drains every ring a few times a
+ * second and
+ *  - appends the events to a compact binary file (mobility_events decodes it)
+ *  - formats them for a text sink (the node publishes /infoLog), dropping
+ *    repeats and holding the rate down to textRate messages a second
+ *
+ * File layout (little endian, as written by the rover):
+ *   header   "MOBEVT1\n"  uint32 version  uint32 reserved
+ *   records  double time  uint16 id  uint8 source  uint8 field count
+ *            then field count doubles
+ */
+
+static const int EVENT_FIELDS = 3;
+
+// New ids go on the end so older event logs still decode
+enum EventId {
+    EVENT_LOG_DROPPED,                          // ring overflowed: count, source
+    EVENT_LOG_STARTED,
+    EVENT_RECORDING_INPUTS,
+    EVENT_RECORDING_FAILED,
+    EVENT_TRANSFORM_STALE,                      // age
+    EVENT_START_DELAY,                          // seconds
+    EVENT_AUTONOMOUS_FIRST_BOOT,
+    EVENT_CENTER_TAG_SEEN,
+    EVENT_NO_STATE,
+    EVENT_TRAVELING,                            // search position, search distance
+    EVENT_SEARCH_EXPANDING,
+    EVENT_NEST_FOUND,
+    EVENT_NEST_REFOUND,
+    EVENT_NEST_LOST,
+    EVENT_CENTER_AVERAGING,
+    EVENT_CENTER_REJECTED,                      // x, y, standard deviations off
+    EVENT_CENTER_DISAGREE,                      // standard error
+    EVENT_DROP_FOUND_CENTER,
+    EVENT_DROP_SQUARED_UP,
+    EVENT_DROP_TOO_MANY_TAGS,
+    EVENT_DROP_SOME_TAGS,
+    EVENT_DROP_TURN_LEFT,                       // tags left, tags right
+    EVENT_DROP_TURN_RIGHT,                      // tags left, tags right
+    EVENT_DROP_TAGS_EVEN,                       // tags left, tags right
+    EVENT_DROP_FEW_TAGS,
+    EVENT_DROP_MORE_TAGS,
+    EVENT_OBSTACLE_WAITING,                     // times re-armed in a row
+    EVENT_OBSTACLE_AVOIDING,
+    EVENT_AVOID_TARGETS_DONE,
+    EVENT_FLIGHT_DUMP,                          // dump number, seconds
+    EVENT_PICKUP_GAVE_UP,
+    EVENT_CYCLE_COMPLETE,                       // cycle number, seconds
+    EVENT_CONTROL_STALLED,                      // seconds since the last tick
+    EVENT_CONTROL_RESUMED,
+    EVENT_ODOMETRY_STALE,                       // age
+    EVENT_ODOMETRY_FRESH,
+    EVENT_MAP_STALE,                            // age
+    EVENT_MAP_FRESH,
+    EVENT_OBSTACLE_STALE,                       // age
+    EVENT_OBSTACLE_FRESH,
+    EVENT_TARGETS_STALE,                        // age
+    EVENT_TARGETS_FRESH,
+    EVENT_NEST_FITTED,                          // x, y, rms residual
+    EVENT_CENTER_RESTARTED,                     // x, y
+    EVENT_IDS
+};
+
+struct Event {
+    double time;                                // seconds (ros time)
+    uint16_t id;                                // EventId
+    uint8_t source;                             // ring it was logged to
+    uint8_t fieldCount;
+    double fields[EVENT_FIELDS];
+};
+
+// Fills in an event, fields past the ones the id uses are left at 0
+Event makeEvent(double time, EventId id, double a = 0, double b = 0, double c = 0);
+
+// The event as the infoLog line it replaces
+std::string formatEvent(const Event& event);
+
+// Single producer/single consumer ring of events.  push() never waits or
+// allocates, if the writer has fallen behind the event is counted and lost.
+class EventRing
+{
+public:
+    EventRing(uint8_t source, unsigned int capacity);
+
+    bool push(const Event& event);
+
+    // Writer side only
+    bool pop(Event& event);
+    uint64_t takeDropped() { return dropped.exchange(0, std::memory_order_relaxed); }
+
+    uint8_t getSource() { return source; }
+
+private:
+    uint8_t source;
+    std::vector<Event> events;
+    unsigned int mask;                          // capacity - 1, capacity is a power of two
+    std::atomic<unsigned int> head;             // next slot to write (producer)
+    std::atomic<unsigned int> tail;             // next slot to read (writer)
+    std::atomic<uint64_t> dropped;
+};
+
+class EventLog
+{
+public:
+    typedef std::function<void(const std::string&)> TextSink;
+
+    EventLog();
+    ~EventLog();
+
+    // Setup, all before start()
+    EventRing* createRing(unsigned int capacity = 1024);
+    bool open(const std::string& path);         // false if the file could not be created
+    void setTextSink(const TextSink& sink, double textRate, double repeatWindow);
+
+    // drainRate in Hz
+    void start(double drainRate);
+
+    // Drains whatever is left and closes the file
+    void stop();
+
+private:
+    void writeLoop();
+    void drain();
+    void write(const Event& event);
+    void text(const Event& event);
+    void sendText(const std::string& line);
+    void flushRepeats();
+
+    std::vector<EventRing*> rings;
+    FILE* file;
+
+    TextSink sink;
+    double textRate;                            // messages a second
+    double repeatWindow;                        // seconds an identical event is held back for
+    double tokens;                              // messages that may go out right now
+    double lastRefill;                          // steady clock seconds
+
+    Event lastText;                             // last event that went to the sink
+    bool hasLastText;
+    unsigned long repeats;                      // identical events held back since
+    unsigned long rateDropped;                  // events the rate limit threw away since the last summary
+
+    double drainRate;
+    std::atomic<bool> running;
+    std::thread worker;
+};
+
+// Reads back what an EventLog wrote
+class EventLogReader
+{
+public:
+    EventLogReader();
+    ~EventLogReader();
+
+    // Returns false if the file can't be read or is not an event log
+    bool open(const std::string& path);
+    void close();
+
+    // Returns false at the end of the file (or at a record cut short)
+    bool next(Event& event);
+
+private:
+    FILE* file;
+};
+
+#endif // EVENTLOG_H
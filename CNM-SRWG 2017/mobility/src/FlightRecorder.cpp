@@ -0,0 +1,241 @@
+#include "FlightRecorder.h"
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "InputLog.h"
+
+using namespace std;
+
+FlightRecorder::FlightRecorder(double seconds, uint64_t inputBytes, unsigned int entries) : writing(false)
+{
+    this->seconds = seconds;
+
+    inputs.resize(inputBytes);
+    scratch.reserve(4096);
+    slots.resize(entries);
+    inputHead = 0;
+    inputUsed = 0;
+    slotTail = 0;
+    slotCount = 0;
+
+    this->entries.resize(entries);
+    entryNext = 0;
+    entryCount = 0;
+
+    cooldown = 30;
+    maxDumps = 20;
+    dumps = 0;
+    lastDump = -1e9;
+}
+
+FlightRecorder::~FlightRecorder()
+{
+    if (writer.joinable()) { writer.join(); }
+}
+
+void FlightRecorder::setDumpPrefix(const string& prefix, double cooldown, int maxDumps)
+{
+    this->prefix = prefix;
+    this->cooldown = cooldown;
+    this->maxDumps = maxDumps;
+}
+
+//RECORDING
+//---------------------------------------------
+
+void FlightRecorder::recordInput(const MobilityInput& input)
+{
+    InputRecordLayout layout = layoutInputRecord(input);
+    if (layout.size > inputs.size()) { return; }
+
+    if (scratch.size() < layout.size) { scratch.resize(layout.size); }
+    encodeInputRecord(input, layout, &scratch[0]);
+
+    //make room, oldest records go first
+    while (slotCount > 0 && (inputUsed + layout.size > inputs.size() || slotCount == slots.size()))
+    {
+        inputUsed -= slots[slotTail].size;
+        slotTail = (slotTail + 1) % slots.size();
+        slotCount--;
+    }
+
+    //copy in, wrapping around the end of the ring if need be
+    uint64_t first = inputs.size() - inputHead;
+    if (first > layout.size) { first = layout.size; }
+
+    memcpy(&inputs[inputHead], &scratch[0], first);
+    if (first < layout.size) { memcpy(&inputs[0], &scratch[first], layout.size - first); }
+
+    InputSlot& slot = slots[(slotTail + slotCount) % slots.size()];
+    slot.offset = inputHead;
+    slot.size = layout.size;
+    slot.time = input.time;
+
+    slotCount++;
+    inputUsed += layout.size;
+    inputHead = (inputHead + layout.size) % inputs.size();
+}
+
+void FlightRecorder::addEntry(const FlightEntry& entry)
+{
+    entries[entryNext] = entry;
+    entryNext = (entryNext + 1) % entries.size();
+    if (entryCount < entries.size()) { entryCount++; }
+}
+
+void FlightRecorder::recordOutput(const MobilityOutput& output, double time)
+{
+    FlightEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.time = time;
+
+    entry.kind = FlightEntry::DRIVE;
+    for (unsigned int i = 0; i < output.drive.size(); i++)
+    {
+        entry.values[0] = output.drive[i].linear;
+        entry.values[1] = output.drive[i].angular;
+        addEntry(entry);
+    }
+
+    entry.kind = FlightEntry::FINGER;
+    for (unsigned int i = 0; i < output.fingerAngles.size(); i++)
+    {
+        entry.values[0] = output.fingerAngles[i];
+        addEntry(entry);
+    }
+
+    entry.kind = FlightEntry::WRIST;
+    for (unsigned int i = 0; i < output.wristAngles.size(); i++)
+    {
+        entry.values[0] = output.wristAngles[i];
+        addEntry(entry);
+    }
+
+    if (output.hasTrackGoal)
+    {
+        entry.kind = FlightEntry::GOAL;
+        entry.values[0] = output.trackGoal.goal.x;
+        entry.values[1] = output.trackGoal.goal.y;
+        entry.values[2] = output.trackGoal.active ? 1 : 0;
+        addEntry(entry);
+    }
+
+    entry.kind = FlightEntry::EVENT;
+    for (unsigned int i = 0; i < output.events.size(); i++)
+    {
+        entry.event = output.events[i];
+        addEntry(entry);
+    }
+}
+
+void FlightRecorder::recordTransition(double time, const char* machine, const char* from, const char* to)
+{
+    FlightEntry entry;
+    memset(&entry, 0, sizeof(entry));
+
+    entry.time = time;
+    entry.kind = FlightEntry::TRANSITION;
+    entry.machine = machine;
+    entry.from = from;
+    entry.to = to;
+
+    addEntry(entry);
+}
+
+//DUMPING
+//---------------------------------------------
+
+bool FlightRecorder::dump(const string& reason, double now)
+{
+    if (prefix.empty() || dumps >= maxDumps || now - lastDump < cooldown || writing) { return false; }
+
+    if (writer.joinable()) { writer.join(); }
+
+    double since = now - seconds;
+
+    //inputs in the window, as an input log
+    vector<uint8_t> inputLog(INPUT_LOG_HEADER_SIZE);
+    writeInputLogHeader(&inputLog[0]);
+
+    for (unsigned int i = 0; i < slotCount; i++)
+    {
+        const InputSlot& slot = slots[(slotTail + i) % slots.size()];
+        if (slot.time < since) { continue; }
+
+        uint64_t at = inputLog.size();
+        inputLog.resize(at + slot.size);
+
+        uint64_t first = inputs.size() - slot.offset;
+        if (first > slot.size) { first = slot.size; }
+
+        memcpy(&inputLog[at], &inputs[slot.offset], first);
+        if (first < slot.size) { memcpy(&inputLog[at + first], &inputs[0], slot.size - first); }
+    }
+
+    //and everything that came out of them
+    vector<FlightEntry> history;
+    history.reserve(entryCount);
+
+    for (unsigned int i = 0; i < entryCount; i++)
+    {
+        const FlightEntry& entry = entries[(entryNext + entries.size() - entryCount + i) % entries.size()];
+        if (entry.time >= since) { history.push_back(entry); }
+    }
+
+    dumps++;
+    lastDump = now;
+
+    stringstream path;
+    path << prefix << "_" << dumps << "_" << reason;
+
+    writing = true;
+    writer = thread(&FlightRecorder::writeDump, this, path.str(), reason, now, std::move(inputLog), std::move(history));
+
+    return true;
+}
+
+void FlightRecorder::writeDump(string path, string reason, double time, vector<uint8_t> inputLog, vector<FlightEntry> history)
+{
+    ofstream log((path + ".inputs").c_str(), ios::binary);
+    log.write((const char*)&inputLog[0], inputLog.size());
+    log.close();
+
+    ofstream text((path + ".txt").c_str());
+    text << fixed << setprecision(3);
+    text << "# " << reason << " at " << time << ", last " << seconds << " s (replay " << path << ".inputs with mobility_replay)" << endl;
+
+    for (unsigned int i = 0; i < history.size(); i++)
+    {
+        const FlightEntry& entry = history[i];
+        text << entry.time - time << " ";
+
+        switch (entry.kind)
+        {
+        case FlightEntry::DRIVE:
+            text << "drive " << entry.values[0] << " " << entry.values[1];
+            break;
+        case FlightEntry::FINGER:
+            text << "finger " << entry.values[0];
+            break;
+        case FlightEntry::WRIST:
+            text << "wrist " << entry.values[0];
+            break;
+        case FlightEntry::GOAL:
+            text << "goal " << entry.values[0] << " " << entry.values[1] << (entry.values[2] != 0 ? "" : " (released)");
+            break;
+        case FlightEntry::TRANSITION:
+            text << "transition " << entry.machine << " " << entry.from << " -> " << entry.to;
+            break;
+        case FlightEntry::EVENT:
+            text << "log " << formatEvent(entry.event);
+            break;
+        }
+
+        text << endl;
+    }
+
+    writing = false;
+}
@@ -0,0 +1,98 @@
+#ifndef FLIGHTRECORDER_H
+#define FLIGHTRECORDER_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+#include "MobilityCore.h"
+#include "EventLog.h"
+
+// One thing the core did, kept by the FlightRecorder
+struct FlightEntry {
+    enum Kind { DRIVE, FINGER, WRIST, GOAL, TRANSITION, EVENT };
+
+    double time;
+    int kind;
+    double values[3];                       // DRIVE linear, angular  FINGER/WRIST angle  GOAL x, y, active
+    const char* machine;                    // TRANSITION only, names out of the state tables
+    const char* from;
+    const char* to;
+    Event event;                            // EVENT only
+};
+
+/**
+ * Always on recorder of the last few seconds of the control thread: every
+ * input the core was stepped on plus the commands, goals, transitions and
+ * events that came out.  Nothing goes to disk until dump() is called when
+ * something went wrong.
+ *
+ * Inputs are kept in the input log encoding in one preallocated byte ring,
+ * so a dump's .inputs file plays back with mobility_replay.  Everything else
+ * goes in a preallocated ring of FlightEntry and is written as a readable
+ * .txt next to it.
+ *
+ * The record* calls are from the control thread only and never lock or
+ * (once the scratch buffer has grown to the biggest input) allocate.
+ * dump() copies the window out on the control thread and leaves the file
+ * writing to a background thread.
+ */
+class FlightRecorder
+{
+public:
+    // seconds kept, bytes for inputs, number of FlightEntry slots
+    FlightRecorder(double seconds, uint64_t inputBytes, unsigned int entries);
+    ~FlightRecorder();
+
+    // Files go to <prefix>_<n>_<reason>.inputs/.txt.  At most maxDumps are
+    // written, no closer together than cooldown seconds.
+    void setDumpPrefix(const std::string& prefix, double cooldown, int maxDumps);
+
+    void recordInput(const MobilityInput& input);
+    void recordOutput(const MobilityOutput& output, double time);
+    void recordTransition(double time, const char* machine, const char* from, const char* to);
+
+    // Returns false if nothing was dumped (limit, cooldown or a dump still
+    // being written)
+    bool dump(const std::string& reason, double now);
+
+    int getDumpCount() { return dumps; }
+    double getSeconds() { return seconds; }
+
+private:
+    struct InputSlot {
+        uint64_t offset;                    // into inputs, may wrap around the end
+        uint32_t size;
+        double time;
+    };
+
+    void addEntry(const FlightEntry& entry);
+    void writeDump(std::string path, std::string reason, double time, std::vector<uint8_t> inputLog, std::vector<FlightEntry> history);
+
+    double seconds;
+
+    std::vector<uint8_t> inputs;            // byte ring of encoded input records
+    std::vector<uint8_t> scratch;           // one record being encoded
+    std::vector<InputSlot> slots;           // where each record in inputs is, oldest at slotTail
+    uint64_t inputHead;                     // next byte to write
+    uint64_t inputUsed;                     // bytes held by live records
+    unsigned int slotTail;
+    unsigned int slotCount;
+
+    std::vector<FlightEntry> entries;
+    unsigned int entryNext;
+    unsigned int entryCount;
+
+    std::string prefix;
+    double cooldown;
+    int maxDumps;
+    int dumps;
+    double lastDump;
+
+    std::atomic<bool> writing;
+    std::thread writer;
+};
+
+#endif // FLIGHTRECORDER_H
@@ -0,0 +1,79 @@
+#include "GoalTracker.h"
+
+#include <cmath>
+#include <angles/angles.h>
+
+GoalTracker::GoalTracker()
+{
+    reached = false;
+}
+
+void GoalTracker::setGoal(const TrackGoal& goal)
+{
+    //same goal posted again by the next planning step, keep going as we were
+    if (goal.active && this->goal.active && goal.goal.x == this->goal.goal.x &&
+        goal.goal.y == this->goal.goal.y && goal.goal.theta == this->goal.goal.theta)
+    {
+        this->goal.rotateFirst = goal.rotateFirst;
+        return;
+    }
+
+    this->goal = goal;
+    reached = false;
+}
+
+bool GoalTracker::update(const geometry_msgs::Pose2D& currentLocation, DriveCommand& command)
+{
+    if (!goal.active || reached) { return false; }
+
+    if (!track(goal, currentLocation, command))
+    {
+        // stop, the planning loop moves on to the next goal
+        command.linear = 0.0;
+        command.angular = 0.0;
+        reached = true;
+    }
+
+    return true;
+}
+
+bool GoalTracker::track(const TrackGoal& goal, const geometry_msgs::Pose2D& currentLocation, DriveCommand& command)
+{
+    // calculate the distance between current and desired heading in radians
+    float errorYaw = angles::shortest_angular_distance(currentLocation.theta, goal.goal.theta);
+
+    //ROTATE
+    //---------------------------------------------
+    // If angle > rotateOnlyAngleTolerance rotate but dont drive forward.
+    if (goal.rotateFirst && fabs(errorYaw) > goal.rotateOnlyAngleTolerance)
+    {
+        int dirToRotate = 1;
+        if (errorYaw < 0) { dirToRotate = -1; }
+
+        // rotate but dont drive 0.05 is to prevent turning in reverse
+        command.linear = 0.05;
+        command.angular = 0.2 * dirToRotate;
+        return true;
+    }
+
+    //SKID STEER
+    //---------------------------------------------
+    // goal not yet reached drive while maintaining proper heading.
+    if (fabs(angles::shortest_angular_distance(currentLocation.theta, atan2(goal.goal.y - currentLocation.y, goal.goal.x - currentLocation.x))) < M_PI_2)
+    {
+        // drive and turn simultaniously
+        command.linear = goal.velocity;
+        command.angular = errorYaw / 2;
+        return true;
+    }
+    // goal is reached but desired heading is still wrong turn only
+    else if (fabs(errorYaw) > 0.1)
+    {
+        // rotate but dont drive
+        command.linear = 0.0;
+        command.angular = errorYaw;
+        return true;
+    }
+
+    return false;
+}
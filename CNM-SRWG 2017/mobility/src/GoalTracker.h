@@ -0,0 +1,51 @@
+#ifndef GOALTRACKER_H
+#define GOALTRACKER_H
+
+#include <geometry_msgs/Pose2D.h>
+
+struct DriveCommand {
+    double linear;
+    double angular;
+
+    bool operator==(const DriveCommand& other) const { return linear == other.linear && angular == other.angular; }
+};
+
+// What the planning loop wants the drive loop to do until it says otherwise.
+struct TrackGoal {
+    TrackGoal() : active(false), rotateFirst(false), velocity(0), rotateOnlyAngleTolerance(0) {}
+
+    bool active;                            // false hands the wheels back to the planning loop
+    bool rotateFirst;                       // turn on the spot until roughly facing goal.theta (STATE_MACHINE_ROTATE)
+    geometry_msgs::Pose2D goal;
+    float velocity;                         // meters/second while driving
+    float rotateOnlyAngleTolerance;         // radians
+};
+
+/**
+ * The heading control of the ROTATE and SKID_STEER states.  Only needs the
+ * goal and the current pose, so it can run in a faster loop than the state
+ * machine that picks the goals.
+ */
+class GoalTracker
+{
+public:
+    GoalTracker();
+
+    void setGoal(const TrackGoal& goal);
+    bool isActive() { return goal.active; }
+
+    // Fills in command and returns true if the drive should be told something.
+    // Once the goal is reached it asks for a stop once and then stays quiet
+    // until a new goal comes in.
+    bool update(const geometry_msgs::Pose2D& currentLocation, DriveCommand& command);
+
+    // Just the control law, the same thing update() does without the bookkeeping.
+    // Returns false when the goal is reached.
+    static bool track(const TrackGoal& goal, const geometry_msgs::Pose2D& currentLocation, DriveCommand& command);
+
+private:
+    TrackGoal goal;
+    bool reached;
+};
+
+#endif // GOALTRACKER_H
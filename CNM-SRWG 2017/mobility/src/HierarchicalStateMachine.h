@@ -0,0 +1,291 @@
+#ifndef HIERARCHICALSTATEMACHINE_H
+#define HIERARCHICALSTATEMACHINE_H
+
+#include <chrono>
+#include <vector>
+
+/**
+ * Table driven hierarchical state machine.
+ *
+ * The structure is two constexpr tables:
+ *  - StateDef {id, parent, name}: the id has to be the row number, parent is
+ *    -1 for the root.  Only leaf states are ever "current".
+ *  - TransitionDef {from, event, to}: from may be a parent state, its
+ *    transitions apply to every state below it unless a child defines the
+ *    same event itself.  to must be a leaf.
+ * Both tables are checked at compile time with HSM_CHECK_TABLES.
+ *
+ * The tables are flattened into a [state][event] lookup when the machine is
+ * built, so dispatch() costs the same however deep or wide the tables are.
+ * A transition runs the exit actions from the current state up to (not
+ * including) the closest common parent and then the entry actions down to
+ * the new state.  A transition to the current state exits and re-enters it.
+ *
+ * Every transition is kept in a small ring buffer with the time it happened
+ * and how long its exit/entry actions took, for profiling.
+ */
+
+struct StateDef {
+    int id;
+    int parent;
+    const char* name;
+};
+
+struct TransitionDef {
+    int from;
+    int event;
+    int to;
+};
+
+struct TransitionRecord {
+    double time;                    // time handed to dispatch()
+    int from;
+    int to;
+    int event;
+    double cost;                    // seconds spent in exit/entry actions
+};
+
+// COMPILE TIME TABLE CHECKS
+//---------------------------------------------
+namespace hsm_check
+{
+    constexpr bool idsAreRows(const StateDef* s, int n, int i)
+    {
+        return i == n || (s[i].id == i && idsAreRows(s, n, i + 1));
+    }
+
+    constexpr bool reachesRoot(const StateDef* s, int n, int state, int steps)
+    {
+        return state == -1 || (state >= 0 && state < n && steps <= n && reachesRoot(s, n, s[state].parent, steps + 1));
+    }
+
+    constexpr bool allReachRoot(const StateDef* s, int n, int i)
+    {
+        return i == n || (reachesRoot(s, n, i, 0) && allReachRoot(s, n, i + 1));
+    }
+
+    constexpr int rootCount(const StateDef* s, int n, int i)
+    {
+        return i == n ? 0 : (s[i].parent == -1 ? 1 : 0) + rootCount(s, n, i + 1);
+    }
+
+    constexpr bool hasChildren(const StateDef* s, int n, int state, int i)
+    {
+        return i < n && (s[i].parent == state || hasChildren(s, n, state, i + 1));
+    }
+
+    constexpr bool transitionValid(const StateDef* s, int n, int events, const TransitionDef& t)
+    {
+        return t.from >= 0 && t.from < n && t.to >= 0 && t.to < n && t.event >= 0 && t.event < events &&
+            !hasChildren(s, n, t.to, 0);
+    }
+
+    constexpr bool sameKey(const TransitionDef& a, const TransitionDef& b)
+    {
+        return a.from == b.from && a.event == b.event;
+    }
+
+    constexpr bool uniqueFrom(const TransitionDef* t, int m, int i, int j)
+    {
+        return j == m || (!sameKey(t[i], t[j]) && uniqueFrom(t, m, i, j + 1));
+    }
+
+    constexpr bool transitionsValid(const StateDef* s, int n, int events, const TransitionDef* t, int m, int i)
+    {
+        return i == m || (transitionValid(s, n, events, t[i]) && uniqueFrom(t, m, i, i + 1) &&
+            transitionsValid(s, n, events, t, m, i + 1));
+    }
+
+    template <int N, int M>
+    constexpr bool tablesValid(const StateDef (&states)[N], const TransitionDef (&transitions)[M], int events)
+    {
+        return idsAreRows(states, N, 0) && allReachRoot(states, N, 0) && rootCount(states, N, 0) == 1 &&
+            transitionsValid(states, N, events, transitions, M, 0);
+    }
+}
+
+#define HSM_CHECK_TABLES(states, transitions, events) \
+    static_assert(hsm_check::tablesValid(states, transitions, events), \
+        #states "/" #transitions ": ids must match rows, one root, no loops, transitions unique and into leaf states")
+
+template <typename Owner>
+class HierarchicalStateMachine
+{
+public:
+    typedef void (Owner::*Action)();
+
+    template <int N, int M>
+    HierarchicalStateMachine(Owner* owner, const StateDef (&states)[N], const TransitionDef (&transitions)[M], int events, int initial)
+    {
+        this->owner = owner;
+        this->states = states;
+        stateCount = N;
+        eventCount = events;
+
+        current = initial;
+        started = false;
+
+        entryActions.assign(N, Action(0));
+        exitActions.assign(N, Action(0));
+
+        //FLATTEN THE TABLE
+        //---------------------------------------------
+        //own transitions first, then fill in the gaps from each parent
+        lookup.assign(N * events, -1);
+
+        for (int state = 0; state < N; state++)
+        {
+            for (int ancestor = state; ancestor != -1; ancestor = states[ancestor].parent)
+            {
+                for (int i = 0; i < M; i++)
+                {
+                    int& slot = lookup[state * events + transitions[i].event];
+                    if (transitions[i].from == ancestor && slot == -1) { slot = transitions[i].to; }
+                }
+            }
+        }
+
+        trace.resize(TRACE_SIZE);
+        traceNext = 0;
+        transitionCount = 0;
+        totalCost = 0;
+    }
+
+    void setEntry(int state, Action action) { entryActions[state] = action; }
+    void setExit(int state, Action action) { exitActions[state] = action; }
+
+    // Runs the entry actions from the root down to the initial state
+    void start()
+    {
+        if (started) { return; }
+
+        started = true;
+        enter(-1, current);
+    }
+
+    // Returns false if the current state has no transition for event
+    bool dispatch(int event, double now)
+    {
+        int target = lookup[current * eventCount + event];
+        if (target == -1) { return false; }
+
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+        int from = current;
+        int common = commonParent(from, target);
+
+        //a transition to itself leaves and comes back in
+        if (from == target) { common = states[from].parent; }
+
+        for (int state = from; state != common; state = states[state].parent)
+        {
+            if (exitActions[state]) { (owner->*exitActions[state])(); }
+        }
+
+        current = target;
+        enter(common, target);
+
+        double cost = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        TransitionRecord& record = trace[traceNext];
+        record.time = now;
+        record.from = from;
+        record.to = target;
+        record.event = event;
+        record.cost = cost;
+
+        traceNext = (traceNext + 1) % TRACE_SIZE;
+        transitionCount++;
+        totalCost += cost;
+
+        return true;
+    }
+
+    int getCurrent() const { return current; }
+
+    // True for the current state and every state above it
+    bool isIn(int state) const
+    {
+        for (int s = current; s != -1; s = states[s].parent)
+        {
+            if (s == state) { return true; }
+        }
+
+        return false;
+    }
+
+    const char* getName(int state) const { return states[state].name; }
+
+    // Oldest first, at most the last TRACE_SIZE transitions
+    std::vector<TransitionRecord> getTrace() const
+    {
+        std::vector<TransitionRecord> records;
+
+        unsigned long kept = transitionCount < TRACE_SIZE ? transitionCount : TRACE_SIZE;
+        for (unsigned long i = 0; i < kept; i++)
+        {
+            records.push_back(trace[(traceNext + TRACE_SIZE - kept + i) % TRACE_SIZE]);
+        }
+
+        return records;
+    }
+
+    unsigned long getTransitionCount() const { return transitionCount; }
+    double getTotalCost() const { return totalCost; }
+
+private:
+    static const int TRACE_SIZE = 64;
+
+    int depth(int state) const
+    {
+        int d = 0;
+        for (int s = state; s != -1; s = states[s].parent) { d++; }
+        return d;
+    }
+
+    int commonParent(int a, int b) const
+    {
+        int da = depth(a);
+        int db = depth(b);
+
+        while (da > db) { a = states[a].parent; da--; }
+        while (db > da) { b = states[b].parent; db--; }
+
+        while (a != b)
+        {
+            a = states[a].parent;
+            b = states[b].parent;
+        }
+
+        return a;
+    }
+
+    // entry actions for everything below from, down to and including to
+    void enter(int from, int to)
+    {
+        if (to == from || to == -1) { return; }
+
+        enter(from, states[to].parent);
+
+        if (entryActions[to]) { (owner->*entryActions[to])(); }
+    }
+
+    Owner* owner;
+    const StateDef* states;
+    int stateCount;
+    int eventCount;
+
+    int current;
+    bool started;
+
+    std::vector<int> lookup;                // [state * eventCount + event] -> target state, -1 for none
+    std::vector<Action> entryActions;
+    std::vector<Action> exitActions;
+
+    std::vector<TransitionRecord> trace;
+    int traceNext;
+    unsigned long transitionCount;
+    double totalCost;
+};
+
+#endif // HIERARCHICALSTATEMACHINE_H
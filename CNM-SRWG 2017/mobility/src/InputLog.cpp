@@ -0,0 +1,417 @@
+#include "InputLog.h"
+
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <ros/serialization.h>
+
+using namespace std;
+
+static const char inputLogMagic[8] = { 'M', 'O', 'B', 'L', 'O', 'G', '1', '\n' };
+static const uint32_t inputLogVersion = 1;
+static const uint64_t inputLogChunk = 4 * 1024 * 1024;     // file grows this much at a time
+
+//RECORDER
+//---------------------------------------------
+
+InputRecorder::InputRecorder()
+{
+    fd = -1;
+    mapping = NULL;
+    mapped = 0;
+    used = 0;
+    records = 0;
+}
+
+InputRecorder::~InputRecorder()
+{
+    close();
+}
+
+bool InputRecorder::open(const string& path)
+{
+    close();
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) { return false; }
+
+    if (!reserve(INPUT_LOG_HEADER_SIZE))
+    {
+        close();
+        return false;
+    }
+
+    writeInputLogHeader(mapping + used);
+    used += INPUT_LOG_HEADER_SIZE;
+
+    return true;
+}
+
+void InputRecorder::close()
+{
+    if (mapping)
+    {
+        munmap(mapping, mapped);
+        mapping = NULL;
+    }
+
+    if (fd >= 0)
+    {
+        //drop the unused part of the last chunk, if this fails the zeroed
+        //tail is still read as the end of the log
+        if (ftruncate(fd, used) != 0) { used = mapped; }
+        ::close(fd);
+        fd = -1;
+    }
+
+    mapped = 0;
+    used = 0;
+    records = 0;
+}
+
+bool InputRecorder::reserve(uint64_t bytes)
+{
+    if (used + bytes <= mapped) { return true; }
+
+    uint64_t newSize = mapped + inputLogChunk;
+    if (newSize < used + bytes) { newSize = used + bytes + inputLogChunk; }
+
+    if (mapping)
+    {
+        munmap(mapping, mapped);
+        mapping = NULL;
+    }
+
+    if (ftruncate(fd, newSize) != 0) { return false; }
+
+    void* area = mmap(NULL, newSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (area == MAP_FAILED) { return false; }
+
+    mapping = (uint8_t*)area;
+    mapped = newSize;
+
+    return true;
+}
+
+void InputRecorder::record(const MobilityInput& input)
+{
+    if (fd < 0) { return; }
+
+    InputRecordLayout layout = layoutInputRecord(input);
+
+    if (!reserve(layout.size))
+    {
+        //out of disk, stop recording rather than take the node down
+        close();
+        return;
+    }
+
+    encodeInputRecord(input, layout, mapping + used);
+    used += layout.size;
+
+    records++;
+}
+
+//RECORD ENCODING
+//---------------------------------------------
+
+void writeInputLogHeader(uint8_t* dst)
+{
+    uint32_t reserved = 0;
+
+    memcpy(dst, inputLogMagic, sizeof(inputLogMagic));
+    memcpy(dst + sizeof(inputLogMagic), &inputLogVersion, sizeof(inputLogVersion));
+    memcpy(dst + sizeof(inputLogMagic) + sizeof(inputLogVersion), &reserved, sizeof(reserved));
+}
+
+//the sensor fields by InputSlot
+static const uint16_t slotFlags[INPUT_SLOTS] = { INPUT_ODOMETRY, INPUT_MAP, INPUT_OBSTACLE, INPUT_TARGETS };
+
+InputRecordLayout layoutInputRecord(const MobilityInput& input)
+{
+    InputRecordLayout layout;
+    layout.flags = 0;
+    layout.targetsSize = 0;
+
+    uint32_t length = sizeof(uint16_t) * 2 + sizeof(double);
+
+    if (input.hasMode) { layout.flags |= INPUT_MODE; length += sizeof(int32_t); }
+    if (input.hasJoystick) { layout.flags |= INPUT_JOYSTICK; length += 2 * sizeof(double); }
+    if (input.hasOdometry) { layout.flags |= INPUT_ODOMETRY; length += 3 * sizeof(double); }
+    if (input.hasMap) { layout.flags |= INPUT_MAP; length += 3 * sizeof(double); }
+    if (input.hasObstacle) { layout.flags |= INPUT_OBSTACLE; length += sizeof(int32_t); }
+    if (input.tick) { layout.flags |= INPUT_TICK; }
+
+    if (input.hasTargets && input.targets)
+    {
+        layout.flags |= INPUT_TARGETS;
+        layout.targetsSize = ros::serialization::serializationLength(*input.targets);
+        length += sizeof(uint32_t) + layout.targetsSize;
+    }
+
+    for (int slot = 0; slot < INPUT_SLOTS; slot++)
+    {
+        if (layout.flags & slotFlags[slot]) { length += 2 * sizeof(double); }
+    }
+
+    if (layout.flags & (INPUT_ODOMETRY | INPUT_MAP | INPUT_OBSTACLE | INPUT_TARGETS)) { layout.flags |= INPUT_TIMES; }
+
+    layout.size = sizeof(uint32_t) + length;
+
+    return layout;
+}
+
+static void put(uint8_t*& dst, const void* data, uint32_t size)
+{
+    memcpy(dst, data, size);
+    dst += size;
+}
+
+void encodeInputRecord(const MobilityInput& input, const InputRecordLayout& layout, uint8_t* dst)
+{
+    uint32_t length = layout.size - sizeof(uint32_t);
+    uint16_t flags = layout.flags;
+    uint16_t reserved = 0;
+
+    put(dst, &length, sizeof(length));
+    put(dst, &flags, sizeof(flags));
+    put(dst, &reserved, sizeof(reserved));
+    put(dst, &input.time, sizeof(input.time));
+
+    if (flags & INPUT_MODE)
+    {
+        int32_t mode = input.mode;
+        put(dst, &mode, sizeof(mode));
+    }
+
+    if (flags & INPUT_JOYSTICK)
+    {
+        put(dst, &input.joyLinear, sizeof(double));
+        put(dst, &input.joyAngular, sizeof(double));
+    }
+
+    if (flags & INPUT_ODOMETRY)
+    {
+        put(dst, &input.odometry.x, sizeof(double));
+        put(dst, &input.odometry.y, sizeof(double));
+        put(dst, &input.odometry.theta, sizeof(double));
+    }
+
+    if (flags & INPUT_MAP)
+    {
+        put(dst, &input.map.x, sizeof(double));
+        put(dst, &input.map.y, sizeof(double));
+        put(dst, &input.map.theta, sizeof(double));
+    }
+
+    if (flags & INPUT_OBSTACLE)
+    {
+        int32_t obstacle = input.obstacle;
+        put(dst, &obstacle, sizeof(obstacle));
+    }
+
+    if (flags & INPUT_TARGETS)
+    {
+        put(dst, &layout.targetsSize, sizeof(layout.targetsSize));
+
+        ros::serialization::OStream stream(dst, layout.targetsSize);
+        ros::serialization::serialize(stream, *input.targets);
+        dst += layout.targetsSize;
+    }
+
+    if (flags & INPUT_TIMES)
+    {
+        for (int slot = 0; slot < INPUT_SLOTS; slot++)
+        {
+            if (!(flags & slotFlags[slot])) { continue; }
+
+            put(dst, &input.times[slot].stamp, sizeof(double));
+            put(dst, &input.times[slot].received, sizeof(double));
+        }
+    }
+}
+
+//READER
+//---------------------------------------------
+
+InputLogReader::InputLogReader()
+{
+    fd = -1;
+    mapping = NULL;
+    size = 0;
+    position = 0;
+    recordEnd = 0;
+}
+
+InputLogReader::~InputLogReader()
+{
+    close();
+}
+
+bool InputLogReader::open(const string& path)
+{
+    close();
+
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) { return false; }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (uint64_t)info.st_size < INPUT_LOG_HEADER_SIZE)
+    {
+        close();
+        return false;
+    }
+
+    size = info.st_size;
+
+    void* area = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (area == MAP_FAILED)
+    {
+        mapping = NULL;
+        close();
+        return false;
+    }
+
+    mapping = (const uint8_t*)area;
+
+    uint32_t version;
+    memcpy(&version, mapping + sizeof(inputLogMagic), sizeof(version));
+
+    if (memcmp(mapping, inputLogMagic, sizeof(inputLogMagic)) != 0 || version != inputLogVersion)
+    {
+        close();
+        return false;
+    }
+
+    position = INPUT_LOG_HEADER_SIZE;
+
+    return true;
+}
+
+void InputLogReader::close()
+{
+    if (mapping)
+    {
+        munmap((void*)mapping, size);
+        mapping = NULL;
+    }
+
+    if (fd >= 0)
+    {
+        ::close(fd);
+        fd = -1;
+    }
+
+    size = 0;
+    position = 0;
+}
+
+bool InputLogReader::get(void* data, uint32_t bytes)
+{
+    if (position + bytes > recordEnd) { return false; }
+
+    memcpy(data, mapping + position, bytes);
+    position += bytes;
+
+    return true;
+}
+
+bool InputLogReader::next(MobilityInput& input)
+{
+    if (!mapping) { return false; }
+
+    uint32_t length;
+    if (position + sizeof(length) > size) { return false; }
+
+    memcpy(&length, mapping + position, sizeof(length));
+    position += sizeof(length);
+
+    //zeroed tail left by a recorder that never closed, or a cut off record
+    if (length == 0 || position + length > size) { return false; }
+
+    recordEnd = position + length;
+    input = MobilityInput();
+
+    uint16_t flags, reserved;
+    if (!get(&flags, sizeof(flags)) || !get(&reserved, sizeof(reserved)) || !get(&input.time, sizeof(input.time)))
+    {
+        return false;
+    }
+
+    bool ok = true;
+
+    if (flags & INPUT_MODE)
+    {
+        int32_t mode = 0;
+        ok = ok && get(&mode, sizeof(mode));
+        input.hasMode = true;
+        input.mode = mode;
+    }
+
+    if (flags & INPUT_JOYSTICK)
+    {
+        ok = ok && get(&input.joyLinear, sizeof(double)) && get(&input.joyAngular, sizeof(double));
+        input.hasJoystick = true;
+    }
+
+    if (flags & INPUT_ODOMETRY)
+    {
+        ok = ok && get(&input.odometry.x, sizeof(double)) && get(&input.odometry.y, sizeof(double)) && get(&input.odometry.theta, sizeof(double));
+        input.hasOdometry = true;
+    }
+
+    if (flags & INPUT_MAP)
+    {
+        ok = ok && get(&input.map.x, sizeof(double)) && get(&input.map.y, sizeof(double)) && get(&input.map.theta, sizeof(double));
+        input.hasMap = true;
+    }
+
+    if (flags & INPUT_OBSTACLE)
+    {
+        int32_t obstacle = 0;
+        ok = ok && get(&obstacle, sizeof(obstacle));
+        input.hasObstacle = true;
+        input.obstacle = obstacle;
+    }
+
+    if (flags & INPUT_TARGETS)
+    {
+        uint32_t targetsSize = 0;
+        ok = ok && get(&targetsSize, sizeof(targetsSize)) && position + targetsSize <= recordEnd;
+
+        if (ok)
+        {
+            apriltags_ros::AprilTagDetectionArray::Ptr targets(new apriltags_ros::AprilTagDetectionArray);
+
+            ros::serialization::IStream stream((uint8_t*)mapping + position, targetsSize);
+            ros::serialization::deserialize(stream, *targets);
+            position += targetsSize;
+
+            input.hasTargets = true;
+            input.targets = targets;
+        }
+    }
+
+    input.tick = (flags & INPUT_TICK) != 0;
+
+    //logs from before the times were recorded step every input as fresh
+    if (flags & INPUT_TIMES)
+    {
+        for (int slot = 0; slot < INPUT_SLOTS; slot++)
+        {
+            if (!(flags & slotFlags[slot])) { continue; }
+
+            ok = ok && get(&input.times[slot].stamp, sizeof(double)) && get(&input.times[slot].received, sizeof(double));
+        }
+    }
+
+    //skip anything a newer recorder may have appended to the record
+    position = recordEnd;
+
+    return ok;
+}
@@ -0,0 +1,108 @@
+#ifndef INPUTLOG_H
+#define INPUTLOG_H
+
+#include <string>
+#include <stdint.h>
+
+#include "MobilityCore.h"
+
+/**
+ * Binary log of every MobilityInput the node fed to the core, so a run can be
+ * stepped through MobilityCore again later (see replay.cpp).
+ *
+ * File layout (little endian, as written by the rover):
+ *   header   "MOBLOG1\n"  uint32 version  uint32 reserved
+ *   records  uint32 length (bytes after this field, 0 marks the end)
+ *            uint16 flags (INPUT_*)  uint16 reserved  double time
+ *            then only the fields whose flag is set, in flag order:
+ *              mode      int32
+ *              joystick  double linear, double angular
+ *              odometry  double x, y, theta
+ *              map       double x, y, theta
+ *              obstacle  int32
+ *              targets   uint32 size + ROS serialized AprilTagDetectionArray
+ *              times     double stamp, double received for each of odometry,
+ *                        map, obstacle and targets that is in the record
+ *
+ * The file is memory mapped and grown in large chunks, so recording a
+ * message is a memcpy into the mapping.  If the node dies without close()
+ * the unused tail is left zeroed, which a reader sees as the end of the log.
+ */
+
+enum InputLogFlags {
+    INPUT_MODE = 1,
+    INPUT_JOYSTICK = 2,
+    INPUT_ODOMETRY = 4,
+    INPUT_MAP = 8,
+    INPUT_OBSTACLE = 16,
+    INPUT_TARGETS = 32,
+    INPUT_TICK = 64,
+    INPUT_TIMES = 128
+};
+
+static const uint32_t INPUT_LOG_HEADER_SIZE = 16;
+
+// The record encoding on its own, for anything else that keeps inputs in
+// this format (FlightRecorder)
+struct InputRecordLayout {
+    uint32_t size;                          // whole record including its length field
+    uint16_t flags;
+    uint32_t targetsSize;
+};
+
+void writeInputLogHeader(uint8_t* dst);     // INPUT_LOG_HEADER_SIZE bytes
+InputRecordLayout layoutInputRecord(const MobilityInput& input);
+void encodeInputRecord(const MobilityInput& input, const InputRecordLayout& layout, uint8_t* dst);
+
+class InputRecorder
+{
+public:
+    InputRecorder();
+    ~InputRecorder();
+
+    // Returns false if the file could not be created
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() { return fd >= 0; }
+
+    // Only call from one thread, the one stepping the core
+    void record(const MobilityInput& input);
+
+    uint64_t getRecordCount() { return records; }
+    uint64_t getBytesWritten() { return used; }
+
+private:
+    bool reserve(uint64_t bytes);
+
+    int fd;
+    uint8_t* mapping;
+    uint64_t mapped;                        // size of the file/mapping
+    uint64_t used;                          // bytes written so far
+    uint64_t records;
+};
+
+class InputLogReader
+{
+public:
+    InputLogReader();
+    ~InputLogReader();
+
+    // Returns false if the file can't be read or is not an input log
+    bool open(const std::string& path);
+    void close();
+
+    // Fills in the next input, returns false at the end of the log (or at a
+    // record cut short by a crash)
+    bool next(MobilityInput& input);
+
+private:
+    bool get(void* data, uint32_t size);
+
+    int fd;
+    const uint8_t* mapping;
+    uint64_t size;
+    uint64_t position;
+    uint64_t recordEnd;                     // end of the record being read
+};
+
+#endif // INPUTLOG_H
@@ -0,0 +1,98 @@
+#include "LatencyHistogram.h"
+
+#include <limits>
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+void LatencyHistogram::reset()
+{
+    for (int i = 0; i < BUCKETS; i++) { counts[i].store(0, std::memory_order_relaxed); }
+
+    total.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    minimum.store(std::numeric_limits<int64_t>::max(), std::memory_order_relaxed);
+    maximum.store(0, std::memory_order_relaxed);
+}
+
+int LatencyHistogram::bucketIndex(int64_t value)
+{
+    if (value < SUB_BUCKETS) { return value < 0 ? 0 : (int)value; }
+
+    //shift so the value lands in [HALF_SUB_BUCKETS, SUB_BUCKETS)
+    int msb = 63 - __builtin_clzll((unsigned long long)value);
+    int shift = msb - 4;
+
+    if (shift > MAX_SHIFT) { return BUCKETS - 1; }
+
+    return SUB_BUCKETS + (shift - 1) * HALF_SUB_BUCKETS + (int)((value >> shift) - HALF_SUB_BUCKETS);
+}
+
+int64_t LatencyHistogram::bucketTop(int index)
+{
+    if (index < SUB_BUCKETS) { return index; }
+
+    int offset = index - SUB_BUCKETS;
+    int shift = offset / HALF_SUB_BUCKETS + 1;
+    int64_t sub = offset % HALF_SUB_BUCKETS + HALF_SUB_BUCKETS;
+
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(int64_t microseconds)
+{
+    if (microseconds < 0) { microseconds = 0; }
+
+    counts[bucketIndex(microseconds)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(microseconds, std::memory_order_relaxed);
+
+    int64_t seen = minimum.load(std::memory_order_relaxed);
+    while (microseconds < seen && !minimum.compare_exchange_weak(seen, microseconds, std::memory_order_relaxed)) { }
+
+    seen = maximum.load(std::memory_order_relaxed);
+    while (microseconds > seen && !maximum.compare_exchange_weak(seen, microseconds, std::memory_order_relaxed)) { }
+}
+
+int64_t LatencyHistogram::min() const
+{
+    if (count() == 0) { return 0; }
+    return minimum.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::mean() const
+{
+    uint64_t n = count();
+    if (n == 0) { return 0; }
+
+    return (double)sum.load(std::memory_order_relaxed) / n;
+}
+
+int64_t LatencyHistogram::percentile(double fraction) const
+{
+    uint64_t n = count();
+    if (n == 0) { return 0; }
+
+    if (fraction < 0) { fraction = 0; }
+    if (fraction > 1) { fraction = 1; }
+
+    uint64_t wanted = (uint64_t)(fraction * n + 0.5);
+    if (wanted < 1) { wanted = 1; }
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++)
+    {
+        seen += counts[i].load(std::memory_order_relaxed);
+
+        if (seen >= wanted)
+        {
+            //never report past what was actually recorded
+            int64_t top = bucketTop(i);
+            return top < max() ? top : max();
+        }
+    }
+
+    return max();
+}
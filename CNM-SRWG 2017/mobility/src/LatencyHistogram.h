@@ -0,0 +1,50 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * HDR style histogram of latencies in microseconds.  Buckets are log-linear:
+ * exact below 32us, above that every power of two is split into 16 buckets,
+ * so any recorded value is known to within about 6% all the way from 1us up
+ * to hours.
+ *
+ * record() is a handful of relaxed atomic adds, any number of threads may
+ * record at once without locking.  Reads are not a consistent snapshot while
+ * records are going on, which is fine for a statistic.
+ */
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    void record(int64_t microseconds);
+    void reset();
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    int64_t min() const;
+    int64_t max() const { return maximum.load(std::memory_order_relaxed); }
+    double mean() const;
+
+    // Value at or below which the given fraction (0 - 1) of the samples fall,
+    // reported as the top of the bucket it lands in
+    int64_t percentile(double fraction) const;
+
+private:
+    static const int SUB_BUCKETS = 32;
+    static const int HALF_SUB_BUCKETS = 16;
+    static const int MAX_SHIFT = 40;
+    static const int BUCKETS = SUB_BUCKETS + MAX_SHIFT * HALF_SUB_BUCKETS;
+
+    static int bucketIndex(int64_t value);
+    static int64_t bucketTop(int index);
+
+    std::atomic<uint64_t> counts[BUCKETS];
+    std::atomic<uint64_t> total;
+    std::atomic<int64_t> sum;
+    std::atomic<int64_t> minimum;
+    std::atomic<int64_t> maximum;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,66 @@
+#include "LoopWatchdog.h"
+
+#include <cmath>
+
+using namespace std;
+
+LoopWatchdog::LoopWatchdog(double period, int stopAfterMissed) : lastStart(0)
+{
+    this->period = period;
+    this->stopAfterMissed = stopAfterMissed;
+
+    rateStart = 0;
+    rateTicks = 0;
+    ticks = 0;
+    overruns = 0;
+    missedPeriods = 0;
+}
+
+void LoopWatchdog::tickStarted(double now)
+{
+    double last = lastStart.load(memory_order_relaxed);
+
+    if (last > 0)
+    {
+        double interval = now - last;
+        jitter.record((int64_t)(fabs(interval - period) * 1e6));
+
+        //a tick more than a period late means the ones in between never ran
+        int missed = (int)floor(interval / period + 0.5) - 1;
+        if (missed > 0) { missedPeriods += missed; }
+    }
+    else
+    {
+        rateStart = now;
+    }
+
+    lastStart.store(now, memory_order_relaxed);
+    ticks++;
+    rateTicks++;
+}
+
+void LoopWatchdog::tickFinished(double now)
+{
+    double took = now - lastStart.load(memory_order_relaxed);
+
+    execution.record((int64_t)(took * 1e6));
+    if (took > period) { overruns++; }
+}
+
+bool LoopWatchdog::stalled(double now) const
+{
+    double last = lastStart.load(memory_order_relaxed);
+
+    return stopAfterMissed > 0 && last > 0 && now - last > (stopAfterMissed + 1) * period;
+}
+
+double LoopWatchdog::takeRate(double now)
+{
+    double elapsed = now - rateStart;
+    double rate = elapsed > 0 ? rateTicks / elapsed : 0;
+
+    rateStart = now;
+    rateTicks = 0;
+
+    return rate;
+}
@@ -0,0 +1,60 @@
+#ifndef LOOPWATCHDOG_H
+#define LOOPWATCHDOG_H
+
+#include <atomic>
+#include <stdint.h>
+
+#include "LatencyHistogram.h"
+
+/**
+ * Keeps an eye on a periodic loop (the 0.1 s control tick): how far every
+ * iteration started from one period after the last (jitter), how long it
+ * ran, how many ran longer than a period (overruns) and how many periods
+ * went by without an iteration at all (missed).
+ *
+ * tickStarted/tickFinished are called from the loop's own thread.
+ * stalled() may be polled from any other thread, it is how a loop that has
+ * stopped altogether gets noticed.  Times are seconds on one clock.
+ */
+class LoopWatchdog
+{
+public:
+    // stopAfterMissed periods without a tick count as a stall, 0 never stalls
+    LoopWatchdog(double period, int stopAfterMissed);
+
+    void tickStarted(double now);
+    void tickFinished(double now);
+
+    // No tick has started for stopAfterMissed periods (any thread)
+    bool stalled(double now) const;
+    double getLastStart() const { return lastStart.load(std::memory_order_relaxed); }
+
+    // Ticks per second since the last call (loop thread)
+    double takeRate(double now);
+
+    double getPeriod() const { return period; }
+    int getStopAfterMissed() const { return stopAfterMissed; }
+
+    const LatencyHistogram& getJitter() const { return jitter; }        // |start - expected start|, microseconds
+    const LatencyHistogram& getExecution() const { return execution; }  // microseconds
+
+    uint64_t getTicks() const { return ticks; }
+    uint64_t getOverruns() const { return overruns; }
+    uint64_t getMissedPeriods() const { return missedPeriods; }
+
+private:
+    double period;
+    int stopAfterMissed;
+
+    std::atomic<double> lastStart;          // 0 until the first tick
+    double rateStart;
+    uint64_t rateTicks;
+
+    LatencyHistogram jitter;
+    LatencyHistogram execution;
+    uint64_t ticks;
+    uint64_t overruns;
+    uint64_t missedPeriods;
+};
+
+#endif // LOOPWATCHDOG_H
@@ -0,0 +1,51 @@
+#ifndef MAILBOX_H
+#define MAILBOX_H
+
+#include <atomic>
+
+// Single slot mailbox between one producer thread and one consumer thread.
+//
+// Only the newest message is kept: posting over an unread message replaces
+// it.  Neither side ever waits or takes a lock, each call is a copy plus one
+// atomic exchange (a triple buffer, so the producer and consumer never touch
+// the same copy at the same time).
+template <typename T>
+class Mailbox
+{
+public:
+    Mailbox() : writeIndex(0), middle(1), readIndex(2) {}
+
+    // Producer side only.
+    void post(const T& message)
+    {
+        buffers[writeIndex] = message;
+
+        // hand the filled buffer over and take whatever was in the middle back
+        unsigned int previous = middle.exchange(writeIndex | FRESH, std::memory_order_acq_rel);
+        writeIndex = previous & INDEX;
+    }
+
+    // Consumer side only.  Returns false and leaves message alone if nothing
+    // new was posted since the last fetch.
+    bool fetch(T& message)
+    {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) { return false; }
+
+        unsigned int previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & INDEX;
+
+        message = buffers[readIndex];
+        return true;
+    }
+
+private:
+    static const unsigned int INDEX = 3;
+    static const unsigned int FRESH = 4;
+
+    T buffers[3];
+    unsigned int writeIndex;                // owned by the producer
+    std::atomic<unsigned int> middle;       // index of the buffer in between, FRESH if not read yet
+    unsigned int readIndex;                 // owned by the consumer
+};
+
+#endif // MAILBOX_H
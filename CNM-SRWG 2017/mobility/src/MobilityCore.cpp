@@ -0,0 +1,2022 @@
+#include "MobilityCore.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+#include <angles/angles.h>
+
+using namespace std;
+
+const unsigned int mapHistorySize = 500;                    // How many points to use in calculating the map average position
+const unsigned int poseHistorySize = 256;                   // Poses kept to place camera frames with, ~10 s of odometry
+
+double const CENTEROFFSET = .95;                            //offset for seeing center
+double const CENTERMAXSTDERR = .25;                         //how unsure (meters) a squared up center point may be before we ignore it
+double const NESTFITCONFIDENCE = .5;                        //how sure a nest fit has to be to skip squaring up on the nest
+
+//How far off (standard deviation, meters) each kind of center point may be
+//---------------------------------------------
+double const CENTERSIGHTSD = .5;                            //one glance, assuming we are facing the middle of the edge
+double const CENTERFITSD = .25;                             //one glance, fitted to the tags
+double const CENTERGPSSD = .15;                             //averaged while squaring up, on top of its standard error
+double const CENTERDROPSD = .35;                            //where we dropped a block, somewhere inside the nest
+double const CENTERDRIFTSD = .01;                           //map drift, meters per square root second
+double const CENTERLOSTSD = 1;                              //added when the nest wasn't where we thought
+double const CENTERSEARCHSIGMAS = 2;                        //start searching this many standard deviations out
+double const AVOIDOBSTDIST = .55;                           //distance to drive for avoiding targets
+double const AVOIDTARGDIST = .45;                           //distance to drive for avoiding targets
+double const REVERSEDIST = .35;                             //distance to back up before turning 180
+double const TURNAWAYDIST = .5;                             //distance to drive away once turned 180
+double const GOALREACHEDDIST = .1;                          //how close counts as being at the goal
+
+//Oldest input (by its stamp) still worth acting on, IN SECONDS
+//---------------------------------------------
+double const MAXODOMETRYAGE = .5;                           //odometry comes in at 10+ Hz
+double const MAXMAPAGE = 1;                                 //so does the GPS fused map pose, but it can lag
+double const MAXOBSTACLEAGE = 1;                            //only reported, an old "no obstacle" is all we have
+double const MAXTARGETSAGE = .5;                            //at search speed the rover moves 10cm in that time
+
+//logged when a slot goes stale/fresh again, by InputSlot
+const EventId staleEvents[INPUT_SLOTS] = { EVENT_ODOMETRY_STALE, EVENT_MAP_STALE, EVENT_OBSTACLE_STALE, EVENT_TARGETS_STALE };
+const EventId freshEvents[INPUT_SLOTS] = { EVENT_ODOMETRY_FRESH, EVENT_MAP_FRESH, EVENT_OBSTACLE_FRESH, EVENT_TARGETS_FRESH };
+
+//Times For Timers (IN SECONDS)
+//---------------------------------------------
+double const cnm2SecTime = 2;
+double const cnm4SecTime = 4;
+double const cnm5SecTime = 5;
+double const cnm8SecTime = 8;
+double const cnm10SecTime = 10;
+
+//MOBILITY STATE MACHINE
+//---------------------------------------------
+//the states keep the STATE_MACHINE_* numbers the rest of the node uses,
+//every DROP_* leaf reports as STATE_MACHINE_DROPOFF
+constexpr StateDef mobilityStates[] = {
+    { MOBILITY_TRANSFORM,           MOBILITY_NAVIGATING, "TRANSFORMING" },
+    { MOBILITY_ROTATE,              MOBILITY_NAVIGATING, "ROTATING" },
+    { MOBILITY_SKID_STEER,          MOBILITY_NAVIGATING, "SKID_STEER" },
+    { MOBILITY_PICKUP,              MOBILITY_AUTONOMOUS, "PICKUP" },
+    { MOBILITY_DROPOFF,             MOBILITY_AUTONOMOUS, "DROPOFF" },
+    { MOBILITY_NAVIGATING,          MOBILITY_AUTONOMOUS, "NAVIGATING" },
+    { MOBILITY_AUTONOMOUS,          -1,                  "AUTONOMOUS" },
+    { MOBILITY_DROP_CENTERING,      MOBILITY_DROPOFF,    "DROP_CENTERING" },
+    { MOBILITY_DROP_DRIVING_IN,     MOBILITY_DROPOFF,    "DROP_DRIVING_IN" },
+    { MOBILITY_DROP_CHECKING,       MOBILITY_DROPOFF,    "DROP_CHECKING" },
+    { MOBILITY_DROP_BACKING_OUT,    MOBILITY_DROPOFF,    "DROP_BACKING_OUT" },
+    { MOBILITY_DROP_RELEASING,      MOBILITY_DROPOFF,    "DROP_RELEASING" }
+};
+
+//REPLAN and TURN_TO_GOAL (obstacles, lost nest) leave DROPOFF from any of
+//its leaves, the next sighting of the nest starts over from centering
+constexpr TransitionDef mobilityTransitions[] = {
+    { MOBILITY_AUTONOMOUS,          EVENT_REPLAN,           MOBILITY_TRANSFORM },
+    { MOBILITY_AUTONOMOUS,          EVENT_TURN_TO_GOAL,     MOBILITY_ROTATE },
+    { MOBILITY_AUTONOMOUS,          EVENT_PICK_UP,          MOBILITY_PICKUP },
+    { MOBILITY_NAVIGATING,          EVENT_DRIVE_TO_GOAL,    MOBILITY_SKID_STEER },
+    { MOBILITY_NAVIGATING,          EVENT_DROP_OFF,         MOBILITY_DROP_CENTERING },
+    { MOBILITY_DROP_CENTERING,      EVENT_DROP_SQUARED,     MOBILITY_DROP_DRIVING_IN },
+    { MOBILITY_DROP_DRIVING_IN,     EVENT_DROP_DRIVEN_IN,   MOBILITY_DROP_CHECKING },
+    { MOBILITY_DROP_CHECKING,       EVENT_DROP_BACK_OUT,    MOBILITY_DROP_BACKING_OUT },
+    { MOBILITY_DROPOFF,             EVENT_DROP_RELEASE,     MOBILITY_DROP_RELEASING }
+};
+
+HSM_CHECK_TABLES(mobilityStates, mobilityTransitions, MOBILITY_EVENTS);
+
+//REVERSE/TURN 180 BEHAVIOUR
+//---------------------------------------------
+constexpr StateDef reverseStates[] = {
+    { REVERSE_ROOT,         -1,                  "REVERSE" },
+    { REVERSE_IDLE,         REVERSE_ROOT,        "IDLE" },
+    { REVERSE_BACKING_OFF,  REVERSE_ROOT,        "BACKING_OFF" },
+    { REVERSE_BACKING_UP,   REVERSE_BACKING_OFF, "BACKING_UP" },
+    { REVERSE_TURNING_180,  REVERSE_BACKING_OFF, "TURNING_180" }
+};
+
+constexpr TransitionDef reverseTransitions[] = {
+    { REVERSE_ROOT,         EVENT_REVERSE_START,     REVERSE_BACKING_UP },
+    { REVERSE_BACKING_UP,   EVENT_REVERSE_BACKED_UP, REVERSE_TURNING_180 },
+    { REVERSE_BACKING_OFF,  EVENT_REVERSE_RESET,     REVERSE_IDLE }
+};
+
+HSM_CHECK_TABLES(reverseStates, reverseTransitions, REVERSE_EVENTS);
+
+MobilityCore::MobilityCore() :
+    mobilityMachine(this, mobilityStates, mobilityTransitions, MOBILITY_EVENTS, MOBILITY_TRANSFORM),
+    reverseMachine(this, reverseStates, reverseTransitions, REVERSE_EVENTS, REVERSE_IDLE),
+    mapLocationStats(mapHistorySize),
+    odometryHistory(poseHistorySize),
+    mapHistory(poseHistorySize),
+    centerGPSStats(10),
+    mapCenterStats(8),
+    mapOdomStats(8),
+    timerWheel(10000000, 256)                               //10 ms slots, 2.56 s round
+{
+    now = 0;
+    firstStep = true;
+    externalGoalTracking = false;
+    requestPriority = PRIORITY_SEARCH;
+    trackGoalPriority = PRIORITY_SEARCH;
+
+    currentMode = 0;
+    targetDetected = false;
+    targetCollected = false;
+    avoidingObstacle = false;
+    lockTarget = false;
+    blockBlock = false;
+    reachedCollectionPoint = false;
+    init = false;
+
+    timerStartTime = 0;
+    startDelayInSeconds = 1;
+    timerTimeElapsed = 0;
+
+    freshness[SLOT_ODOMETRY].maxAge = MAXODOMETRYAGE;
+    freshness[SLOT_MAP].maxAge = MAXMAPAGE;
+    freshness[SLOT_OBSTACLE].maxAge = MAXOBSTACLEAGE;
+    freshness[SLOT_TARGETS].maxAge = MAXTARGETSAGE;
+    staleFramesDropped = 0;
+
+    //a bad nest sighting should not drag the whole estimate with it
+    nestEstimate.setDrift(CENTERDRIFTSD);
+    nestEstimate.setGate(3.0, 0.5, 3);
+    centerGPSStats.setOutlierRejection(3.0, 4, 0.5);
+
+    searchVelocity = 0.2;                                   // meters/second  ORIGINALLY .2
+    rotateOnlyAngleTolerance = 0.5;                         //jms chnaged from .4
+    returnToSearchDelay = 10;
+
+    centerSeen = false;
+    cnmHasCenterLocation = false;
+    cnmLocatedCenterFirst = false;
+
+    cnmCenteringFirstTime = true;
+    cnmCentering = false;
+
+    cnmFirstBootProtocol = true;
+    cnmHasWaitedInitialAmount = false;
+    cnmInitialPositioningComplete = false;
+
+    cnmAvoidObstacle = false;
+    cnmObstacleRearms = 0;
+    cnmSeenAnObstacle = false;
+    cnmStartObstDetect = false;
+    cnmCanCollectTags = true;
+
+    cnmFinishedPickUp = true;
+    cnmWaitToReset = false;
+    numTagsCarrying = 0;
+
+    isDroppingOff = false;
+    seeMoreTargets = false;
+
+    cnmAvoidTargets = false;
+    cnmRotate = false;
+
+    firstTimeInBoot = true;
+
+    firstTimeRotate = true;
+    firstTimeSeeObst = true;
+
+    IWasLost = false;
+    searchingForCenter = false;
+
+    //CNM SEQUENCES
+    //----------------------------------------------------
+    //each step ends when it got where it was going, the time is only a limit
+
+    //-----INITIAL CENTER FIND-----
+    firstBootSequence
+        .wait(cnm10SecTime)                                                         //Gather position data
+        .until([this] { return distanceFrom(goalLocation) < GOALREACHEDDIST; }, cnm10SecTime,
+               [this] { CNMInitPositioning(); })                                    //Drive Forward
+        .until([this] { return facingGoal(currentLocationMap) && distanceFrom(firstBootMark) > .45 - GOALREACHEDDIST; }, cnm10SecTime,
+               [this] { firstBootMark = currentLocation; CNMForwardInitTimerDone(); })  //Turn 180 and drive back
+        .then([this] { CNMInitialWait(); });                                        //Run Interrupted Search
+
+    //-----REVERSE BEHAVIOR-----
+    reverseSequence
+        .until([this] { return distanceFrom(reverseMark) > REVERSEDIST; }, cnm2SecTime,
+               [this] { reverseMark = currentLocation; })                           //Back Up
+        .until([this] { return facingGoal(currentLocation) && distanceFrom(reverseMark) > TURNAWAYDIST; }, cnm8SecTime,
+               [this] { reverseMark = currentLocation; CNMReverseTimer(); })        //Turn 180 and drive away
+        .then([this] { CNMTurn180(); });                                            //Run Interrupted Search
+
+    //CNM TIMERS
+    //----------------------------------------------------
+
+    //-----DROPOFF TIMERS-----
+    //Waits to reset Wrist/Gripper to a lowered driving state (Prevents trapping blocks under gripper)
+    cnmWaitToResetWGTimer.setup(&clock, cnm2SecTime, &MobilityCore::cnmWaitToResetWG, "cnmWaitToResetWGTimer");
+
+    //-----PICKUP TIMERS-----
+    //Waits a time after pickup before viewing other targets as obstacles
+    cnmAfterPickUpTimer.setup(&clock, cnm2SecTime, &MobilityCore::cnmFinishedPickUpTime, "cnmAfterPickUpTimer");
+
+    //-----DROPOFF TIMERS-----
+    cnmDropOffDriveTimer.setup(&clock, cnm5SecTime, &MobilityCore::CNMDropOffDrive, "cnmDropOffDriveTimer");
+    cnmDropOffTimeOut.setup(&clock, cnm4SecTime, &MobilityCore::CNMDropTimedOut, "cnmDropOffTimeOut");
+
+    //AVOIDING TARGETS IF CARRYING ONE
+    cnmAvoidOtherTargetTimer.setup(&clock, cnm4SecTime, &MobilityCore::CNMAvoidOtherTargets, "cnmAvoidOtherTargetTimer");
+
+    //-----OBSTACLE AVOIDANCE-----
+    cnmAvoidObstacleTimer.setup(&clock, cnm10SecTime, &MobilityCore::CNMAvoidObstacle, "cnmAvoidObstacleTimer");            //Timer for Obstacle Avoidance
+    cnmTimeBeforeObstDetect.setup(&clock, cnm8SecTime, &MobilityCore::CNMWaitBeforeDetectObst, "cnmTimeBeforeObstDetect");    //Timer to allow rovers to start detecting Obstacles
+    cnmWaitToCollectTagsTimer.setup(&clock, cnm4SecTime, &MobilityCore::CNMWaitToCollectTags, "cnmWaitToCollectTagsTimer");     //Timer to allow rovers to start picking up tags again
+
+    //-----CENTERFIND TIMERS-----
+    cnmFinishedCenteringTimer.setup(&clock, cnm4SecTime, &MobilityCore::CNMCenterTimerDone, "cnmFinishedCenteringTimer");       //CENTERING TIMER
+
+    addTimer(cnmWaitToResetWGTimer);
+    addTimer(cnmAfterPickUpTimer);
+    addTimer(cnmDropOffDriveTimer);
+    addTimer(cnmDropOffTimeOut);
+    addTimer(cnmAvoidOtherTargetTimer);
+    addTimer(cnmAvoidObstacleTimer);
+    addTimer(cnmTimeBeforeObstDetect);
+    addTimer(cnmWaitToCollectTagsTimer);
+    addTimer(cnmFinishedCenteringTimer);
+
+    mobilityMachine.setEntry(MOBILITY_DROPOFF, &MobilityCore::CNMEnterDropOff);
+    mobilityMachine.setExit(MOBILITY_DROPOFF, &MobilityCore::CNMExitDropOff);
+    mobilityMachine.setEntry(MOBILITY_DROP_DRIVING_IN, &MobilityCore::CNMEnterDrivingIn);
+
+    reverseMachine.setEntry(REVERSE_BACKING_UP, &MobilityCore::CNMEnterBackingUp);
+    reverseMachine.setExit(REVERSE_BACKING_OFF, &MobilityCore::CNMExitBackingOff);
+
+    mobilityMachine.start();
+    reverseMachine.start();
+
+    pickUpController.setClock(&clock);
+    dropOffController.setClock(&clock);
+
+    output.drive.reserve(8);
+    output.fingerAngles.reserve(4);
+    output.wristAngles.reserve(4);
+    output.events.reserve(16);
+    output.timerMarks.reserve(16);
+    dueTimers.reserve(timers.size());
+}
+
+const MobilityOutput& MobilityCore::step(const MobilityInput& input)
+{
+    output.clear();
+
+    if (input.time > now) { now = input.time; }
+    clock.setSeconds(now);
+
+    if (firstStep)
+    {
+        //what the node used to do from main() once it was up
+        timerStartTime = now;
+        targetDetectedReset();
+
+        logEvent(EVENT_START_DELAY, startDelayInSeconds);
+
+        firstStep = false;
+    }
+
+    fireDueTimers();
+
+    if (input.hasMode)
+    {
+        RequestScope scope(this, PRIORITY_MANUAL);
+        modeHandler(input.mode);
+    }
+
+    if (input.hasJoystick)
+    {
+        RequestScope scope(this, PRIORITY_MANUAL);
+        joyCmdHandler(input.joyLinear, input.joyAngular);
+    }
+
+    if (input.hasOdometry && takeInput(SLOT_ODOMETRY, input.times[SLOT_ODOMETRY]))
+    {
+        currentLocation = input.odometry;
+        odometryHistory.add(inputStamp(input, SLOT_ODOMETRY), currentLocation);
+    }
+
+    if (input.hasMap && takeInput(SLOT_MAP, input.times[SLOT_MAP]))
+    {
+        currentLocationMap = input.map;
+        mapHistory.add(inputStamp(input, SLOT_MAP), currentLocationMap);
+    }
+
+    if (input.hasObstacle && takeInput(SLOT_OBSTACLE, input.times[SLOT_OBSTACLE]))
+    {
+        RequestScope scope(this, PRIORITY_OBSTACLE);
+        obstacleHandler(input.obstacle);
+    }
+
+    //acting on an old camera frame steers at where the target used to be
+    if (input.hasTargets && input.targets && takeInput(SLOT_TARGETS, input.times[SLOT_TARGETS]))
+    {
+        RequestScope scope(this, targetCollected ? PRIORITY_DROPOFF : PRIORITY_SEARCH);
+        targetHandler(input.targets, inputStamp(input, SLOT_TARGETS));
+    }
+
+    if (input.tick)
+    {
+        //sequences move on once per control cycle, just before the state
+        //machine looks at what they changed
+        firstBootSequence.update(now);
+        reverseSequence.update(now);
+
+        checkFreshness();
+        mobilityStateMachine();
+        holdStillIfBlind();
+    }
+
+    // one command per actuator goes out, whoever ranks highest
+    arbiter.resolve(output.drive, output.fingerAngles, output.wristAngles);
+
+    if (output.hasTrackGoal && output.trackGoal.active && !arbiter.mayDrive(trackGoalPriority))
+    {
+        output.trackGoal = TrackGoal();
+    }
+
+    if (input.tick) { arbiter.endCycle(); }
+
+    // anything the core drives itself (or a tick that didn't ask for goal
+    // tracking) takes the wheels back from the drive loop
+    if (externalGoalTracking && !output.hasTrackGoal && (input.tick || !output.drive.empty()))
+    {
+        output.hasTrackGoal = true;
+        output.trackGoal = TrackGoal();
+    }
+
+    cycleProfiler.update(now, cyclePhase());
+
+    return output;
+}
+
+bool MobilityCore::takeInput(int slot, const InputTimes& times)
+{
+    InputFreshness& input = freshness[slot];
+
+    double stamp = times.stamp > 0 ? times.stamp : now;
+    double received = times.received > 0 ? times.received : now;
+
+    //nothing goes back to an older input than the one already taken.  A
+    //late pose or obstacle is still the best there is, a late camera frame
+    //is thrown away.
+    if (stamp < input.stamp) { return false; }
+
+    if (slot == SLOT_TARGETS && input.maxAge > 0 && now - stamp > input.maxAge)
+    {
+        staleFramesDropped++;
+        return false;
+    }
+
+    input.stamp = stamp;
+    input.delay = max(0.0, received - stamp);
+
+    return true;
+}
+
+double MobilityCore::inputStamp(const MobilityInput& input, int slot)
+{
+    return input.times[slot].stamp > 0 ? input.times[slot].stamp : now;
+}
+
+double MobilityCore::getInputAge(int slot)
+{
+    if (freshness[slot].stamp <= 0) { return -1; }
+
+    return now - freshness[slot].stamp;
+}
+
+void MobilityCore::checkFreshness()
+{
+    for (int slot = 0; slot < INPUT_SLOTS; slot++)
+    {
+        InputFreshness& input = freshness[slot];
+
+        //nothing heard yet is the start up delay's problem, not staleness
+        double age = getInputAge(slot);
+        bool stale = input.maxAge > 0 && age > input.maxAge;
+
+        if (stale == input.stale) { continue; }
+
+        input.stale = stale;
+
+        if (stale) { logEvent(staleEvents[slot], age); }
+        else { logEvent(freshEvents[slot]); }
+    }
+
+    //the camera stopped talking, what it last saw is no longer in view
+    if (freshness[SLOT_TARGETS].stale)
+    {
+        centerSeen = false;
+        perception.clear();
+        nestFit.clear();
+    }
+}
+
+void MobilityCore::holdStillIfBlind()
+{
+    //without a current odometry every distance and heading the behaviours
+    //steer by is wrong, wait (above any behaviour, below the joystick)
+    if (!freshness[SLOT_ODOMETRY].stale || !(currentMode == 2 || currentMode == 3)) { return; }
+
+    RequestScope scope(this, PRIORITY_OBSTACLE);
+    sendDriveCommand(0, 0);
+}
+
+void MobilityCore::setTimerTracing(bool trace)
+{
+    for (unsigned int i = 0; i < timers.size(); i++)
+    {
+        timers[i]->setMarks(trace ? &output.timerMarks : NULL);
+    }
+}
+
+void MobilityCore::addTimer(StepTimer& timer)
+{
+    timer.attach(&timerWheel, timers.size());
+    timers.push_back(&timer);
+}
+
+void MobilityCore::fireDueTimers()
+{
+    //earliest deadline first, a timer stopped or restarted by one that fired
+    //before it no longer counts as due
+    dueTimers.clear();
+    timerWheel.advance(clock.nanoseconds(), dueTimers);
+
+    for (unsigned int i = 0; i < dueTimers.size(); i++)
+    {
+        StepTimer* timer = timers[dueTimers[i]];
+        if (timer->due()) { timer->fire(this); }
+    }
+}
+
+void MobilityCore::sendDriveCommand(double linearVel, double angularError)
+{
+    arbiter.requestDrive(requestPriority, linearVel, angularError);
+}
+
+void MobilityCore::sendFingerCommand(float angle)
+{
+    arbiter.requestFinger(requestPriority, angle);
+}
+
+void MobilityCore::sendWristCommand(float angle)
+{
+    arbiter.requestWrist(requestPriority, angle);
+}
+
+void MobilityCore::logEvent(EventId id, double a, double b, double c)
+{
+    output.events.push_back(makeEvent(now, id, a, b, c));
+}
+
+/*************************
+* HANDLERS *
+*************************/
+
+void MobilityCore::modeHandler(int mode)
+{
+    currentMode = mode;
+    sendDriveCommand(0.0, 0.0);
+}
+
+void MobilityCore::joyCmdHandler(double linear, double angular)
+{
+    if (currentMode == 0 || currentMode == 1)
+    {
+        sendDriveCommand(fabs(linear) >= 0.1 ? linear : 0, fabs(angular) >= 0.1 ? angular : 0);
+    }
+}
+
+void MobilityCore::targetDetectedReset()
+{
+    targetDetected = false;
+
+    // close fingers
+    sendFingerCommand(0);
+
+    // raise wrist
+    sendWristCommand(0);
+}
+
+//DEFAULT MAP AVERAGE
+//-----------------------------------
+
+void MobilityCore::mapAverage()
+{
+    // store currentLocation in the averaging window, the window keeps
+    // running sums so this does not depend on mapHistorySize
+    mapLocationStats.add(currentLocationMap);
+
+    // headings are averaged on the circle so they survive wrapping at +-PI
+    currentLocationAverage = mapLocationStats.mean();
+
+    // the map -> odom transform of the center is done by the node, see
+    // MobilityNode::updateCenterLocation()
+}
+
+// This is the top-most logic control block organised as a state machine.
+// This function calls the dropOff, pickUp, and search controllers.
+// This block passes the goal location to the proportional-integral-derivative
+// controllers in the abridge package.
+void MobilityCore::mobilityStateMachine()
+{
+
+    string stateName;
+
+    // calls the averaging function, an old map pose would only be counted again
+    if (!freshness[SLOT_MAP].stale) { mapAverage(); }
+
+    // Robot is in automode
+    if (currentMode == 2 || currentMode == 3)
+    {
+
+        //cnmFirstBootProtocol runs the first time the robot is set to autonomous mode (2 || 3)
+        if(cnmFirstBootProtocol) { CNMFirstBoot(); }
+
+        if(reverseMachine.getCurrent() == REVERSE_BACKING_UP) 
+	{ 
+            sendDriveCommand(-0.2, 0.0);
+
+	    return;
+	}
+
+        // time since timerStartTime was set to current time
+        timerTimeElapsed = now - timerStartTime;
+
+        // init code goes here. (code that runs only once at start of
+        // auto mode but wont work in main goes here)
+        if (!init)
+        {
+            if (timerTimeElapsed > startDelayInSeconds)
+            {
+                // Set the location of the center circle location in the map
+                // frame based upon our current average location on the map.
+                centerLocationMap.x = currentLocationAverage.x;
+                centerLocationMap.y = currentLocationAverage.y;
+                centerLocationMap.theta = currentLocationAverage.theta;
+
+                // initialization has run
+                init = true;
+            }
+            else { return; }
+        }
+
+        // If no target collected or no detected blocks,
+        // set fingers to open wide and to raised position.
+        if (!targetCollected && !targetDetected)
+        {
+
+            //SET NORMAL DRIVING GRIPPER/WRIST ANGLE
+            //---------------------------------------------
+            if(!cnmWaitToReset)
+            {
+
+		//GRIPPER OPTIMUM SETTING:
+		//FINGERS:  0 - 2      (Any further and fingers deform[AKA right finger keeps rotating and left doesn't])
+		//WRIST:    0 - 1.6    (Any further and will scrape ground if rover hits bumps)
+
+                // close fingers all the way
+                sendFingerCommand(0.0);
+
+                //raise wrist partially (avoid obstacle calls)
+                sendWristCommand(0.6);	//0.6 is to avoid dragging cube on the ground
+            }
+        }
+
+        // Select rotation or translation based on required adjustment
+        switch (getStateMachineState())
+        {
+            // If no adjustment needed, select new goal
+        case STATE_MACHINE_TRANSFORM:
+        {
+            stateName = "TRANSFORMING";
+
+            if (!CNMTransformCode()) { break; }
+            //Purposefully fall through to next case without breaking
+        }
+
+        // Calculate angle between currentLocation.theta and goalLocation.theta
+        // Rotate left or right depending on sign of angle
+        // Stay in this state until angle is minimized
+        case STATE_MACHINE_ROTATE:
+        {
+            stateName = "ROTATING";
+
+            if(CNMRotateCode()) { break; }
+
+            //Purposefully fall through to next case without breaking
+        }
+
+        // Calculate angle between currentLocation.x/y and goalLocation.x/y
+        // Drive forward
+        // Stay in this state until angle is at least PI/2
+        case STATE_MACHINE_SKID_STEER:
+        {
+            stateName = "SKID_STEER";
+
+            CNMSkidSteerCode();
+
+            break;
+        }
+
+        case STATE_MACHINE_PICKUP:
+        {
+            stateName = "PICKUP";
+
+            RequestScope scope(this, PRIORITY_PICKUP);
+            if(CNMPickupCode()) { return; }
+
+            break;
+        }
+
+        case STATE_MACHINE_DROPOFF:
+        {
+            stateName = "DROPOFF";
+
+            RequestScope scope(this, PRIORITY_DROPOFF);
+            CNMDropOffStepCode();
+
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+
+        } /* end of switch() */
+    }
+
+    // mode is NOT auto
+    else
+    {
+        // publish current state for the operator to see
+        stateName = "WAITING";
+    }
+
+    // state machine string for the user
+    output.hasStateName = true;
+    output.stateName = stateName;
+}
+
+
+void MobilityCore::targetHandler(const apriltags_ros::AprilTagDetectionArray::ConstPtr& message, double stamp)
+{
+
+    // If in manual mode do not try to automatically pick up the target
+    if (currentMode == 1 || currentMode == 0) { return; }
+
+
+    // found a target april tag and looking for april cubes;
+    // with safety timer at greater than 5 seconds.
+    //---------------------------------------------
+    PickUpResult result;
+    //---------------------------------------------
+
+    centerSeen = false;             //set to false
+    perception.clear();
+    nestFit.clear();
+
+    bool looking = message->detections.size() > 0 && !reachedCollectionPoint;
+
+    //one pass over the detections, everything below reads the frame
+    //---------------------------------------------
+    if (looking) { perception.build(*message); }
+
+    //place the tags using where we were when the image was taken.  An empty
+    //frame is projected too, the tracker needs to know what was in view.
+    geometry_msgs::Pose2D odometryThen = currentLocation;
+    geometry_msgs::Pose2D mapThen = currentLocationMap;
+    odometryHistory.at(stamp, odometryThen);
+    mapHistory.at(stamp, mapThen);
+
+    perception.project(odometryThen, mapThen);
+
+    //at the collection point the blocks in view are in the nest
+    if (!reachedCollectionPoint) { pickUpController.track(perception); }
+
+    // if a target is detected and we are looking for center tags
+    if (looking)
+    {
+        if (perception.nestCount > 0)
+        {
+            nestFit.fit(perception);
+
+            centerSeen = true;
+            cnmHasCenterLocation = true;
+        }
+
+        if(perception.targetCount == 0 && isDroppingOff) { seeMoreTargets = 0; }
+
+        //dropOffController.setDataTargets(count,countLeft,countRight);
+
+        //CNM MODIFIED: If we see the center and don't have a target collected
+        //---------------------------------------------
+        if(centerSeen && !targetCollected && perception.nestCount > 2)
+        {
+
+            if(reverseMachine.getCurrent() == REVERSE_TURNING_180) 
+            { 
+                CNMReverseReset();
+                goalLocation = currentLocation;
+                //goalLocation = currentLocationMap;
+            }
+
+            CNMCenterGPS();
+
+            bool gotEnoughPoints = centerGPSStats.count() > 3;
+
+            if(cnmCenteringFirstTime)
+            {
+                cnmCentering = true;
+                cnmCenteringFirstTime = false;
+
+                logEvent(EVENT_CENTER_TAG_SEEN);
+
+                goalLocation = currentLocation;
+                //goalLocation = currentLocationMap;
+                
+                mobilityMachine.dispatch(EVENT_REPLAN, now);
+
+                if(cnmFirstBootProtocol)
+                {
+                    cnmFirstBootProtocol = false;
+                    cnmInitialPositioningComplete = true;
+
+                    firstBootSequence.cancel();
+                }
+            }
+
+            //a good enough fit already knows where the center is, no need
+            //to wiggle until the tags are on both sides of the image
+            bool fitted = nestFit.valid && nestFit.confidence >= NESTFITCONFIDENCE && gotEnoughPoints;
+            if(fitted)
+            {
+                sendDriveCommand(0.0, 0.0);
+                logEvent(EVENT_NEST_FITTED, nestFit.x, nestFit.y, nestFit.residual);
+            }
+
+            if((fitted || CNMCentered()) && !targetCollected && gotEnoughPoints)
+            {
+
+                //If we haven't seen the center before
+                //---------------------------------------------
+                if(!cnmLocatedCenterFirst) { CNMFirstSeenCenter(); }
+
+                //If we have seen the center before
+                //---------------------------------------------
+                else if(cnmLocatedCenterFirst && cnmInitialPositioningComplete) { CNMRefindCenter(); }
+
+                CNMAVGCenterGPS();
+
+                cnmFinishedCenteringTimer.start();
+
+                searchController.doAnotherOctagon();
+
+                if(!isReversing() && cnmInitialPositioningComplete) 
+                {
+                    CNMReverseReset();
+                    CNMStartReversing();
+                }
+            }
+
+            //FINAL STEPS
+            //---------------------------------------------
+            targetDetected = false;
+            pickUpController.reset();
+            return;
+        }
+
+        //If we see the center, have a target, and are not in an avoiding targets state
+        //---------------------------------------------
+        if (centerSeen && targetCollected && !cnmAvoidTargets && !isReversing() && !mobilityMachine.isIn(MOBILITY_DROPOFF))
+        {
+            mobilityMachine.dispatch(EVENT_REPLAN, now);
+            goalLocation = cnmCenterLocation;
+        }
+
+        // end found target and looking for center tags
+    }
+
+    //if we see an april tag, are not carrying a target, and if timer is ok
+    //---------------------------------------------
+    if (perception.targetCount > 0 && !targetCollected && timerTimeElapsed > 5)
+    {
+        //Check to see if have found the nests location at all
+        //---------------------------------------------
+        if(cnmHasCenterLocation)
+        {
+            //If we are't allowed to pick up a tag
+            //---------------------------------------------
+            if (!cnmCanCollectTags)
+            {
+                //This code is to prevent the rover from picking up targets at inopportune moments
+                    //- Called After Successful DropOff  (So it doesn't try to pick up blocks in center)
+                    //- Called After Avoiding Obstacle   (So it doesn't try to pick up blocks being carried by other rovers)
+
+                //Ignore the tag, keep avoiding the obstacle
+                targetDetected = false;
+
+                if(mobilityMachine.getCurrent() == MOBILITY_PICKUP)
+                {
+                    mobilityMachine.dispatch(EVENT_REPLAN, now);
+                    pickUpController.reset();
+                }
+
+                //cnmCanCollectTags is set to true on a short timer triggered after avoiding an obstacle
+            }
+
+            //If we see the center, ignore the target and back up!
+            //---------------------------------------------
+            else if(centerSeen)
+            {
+                targetDetected = false;
+
+                mobilityMachine.dispatch(EVENT_TURN_TO_GOAL, now);
+
+                pickUpController.reset();
+
+                CNMStartReversing();
+            }
+
+            //Pick Up The Target
+            //---------------------------------------------
+            else
+            {
+                //Check to see if we are currently trying to reverse
+                //---------------------------------------------
+                if(!isReversing())
+                {
+                    CNMReverseReset();
+
+                    targetDetected = true;
+
+                    //pickup state so target handler can take over driving.
+                    //---------------------------------------------
+                    RequestScope scope(this, PRIORITY_PICKUP);
+                    mobilityMachine.dispatch(EVENT_PICK_UP, now);
+                    result = pickUpController.selectTarget(perception, currentLocation);
+
+                    CNMTargetPickup(result);
+                }
+            }
+
+        }
+
+        //If not gotten the centers point, avoid the target
+        //---------------------------------------------
+        else
+        {
+            targetDetected = false;
+        }
+    }
+
+    //CNM ADDED: if we see a target and have already picked one up
+    //---------------------------------------------
+    else if(perception.targetCount > numTagsCarrying && targetCollected && cnmFinishedPickUp)
+    {
+    
+        logEvent(EVENT_NO_STATE);
+    
+        //Avoid Targets
+        //---------------------------------------------
+        //- 2 Conditions for avoiding targets:
+            //1.) We haven't found the center yet
+            //2.) We are currently carrying a block
+                //a.)  Do we see the center?  If so we need to continue drop off but stop
+                //b.)  If not, just avoid!
+
+        //Do we currently see more tags than we should?
+        //if(isDroppingOff) { seeMoreTargets = true; }
+    }
+
+}
+
+
+void MobilityCore::obstacleHandler(int obstacle)
+{
+    if (currentMode == 1 || currentMode == 0) { return; }
+
+    //no matter what we receive from obstacle
+    else if ((!targetDetected || targetCollected) && (obstacle > 0))
+    {
+
+        //If we can start looking for obstacles
+        if(cnmStartObstDetect)
+        {            
+            cnmSeenAnObstacle = true;                       //We saw an obstacle
+
+            cnmCanCollectTags = false;                      //Don't try picking anything up
+	    
+            cnmAvoidObstacleTimer.start();
+
+            if(!cnmAvoidObstacle)
+            {
+                if(firstTimeSeeObst)
+                {
+                    //infoLog("SEE OBSTACLE; STOPPING");
+                    //firstTimeSeeObst = false;
+                }
+
+                sendDriveCommand(0.0, 0.0);
+            }
+            else
+            {
+                if(firstTimeRotate)
+                {
+                    //infoLog("ROTATING");
+
+                    searchController.obstacleWasAvoided();
+
+                    firstTimeRotate = false;
+                }
+
+                //no matter what, turn left
+                sendDriveCommand(0.0, 0.2);
+
+                //if searching left, turn left
+                //else { sendDriveCommand(0.0, 0.2); }
+
+            }
+        }
+    }
+
+    //if we saw an obstacle but no longer see one
+    else if (cnmSeenAnObstacle && (!targetDetected || targetCollected) && (obstacle == 0))
+    {
+
+        cnmSeenAnObstacle = false;                      //We no longer see an obstacle
+	cnmWaitToCollectTagsTimer.start();		//Start timer to start looking for targets again
+
+        if(cnmAvoidObstacle)
+        {
+            if(!firstTimeRotate)
+            {
+                //infoLog("DRIVING 30 degrees to the left!");
+
+                firstTimeRotate = true;
+            }
+
+	        goalLocation.theta = currentLocation.theta + (M_PI/6);
+
+	        goalLocation.x = currentLocation.x + (AVOIDOBSTDIST * (cos(goalLocation.theta)));
+	        goalLocation.y = currentLocation.y + (AVOIDOBSTDIST * (sin(goalLocation.theta)));
+
+	        mobilityMachine.dispatch(EVENT_TURN_TO_GOAL, now);
+
+	        cnmAvoidObstacle = false;
+        }
+	else
+	{
+       		cnmAvoidObstacleTimer.stop();                   //Double tap stopping the timer in case obstacle moves
+	}
+        
+	firstTimeSeeObst = true;
+    }
+
+    // the front ultrasond is blocked very closely. 0.14m currently
+    if (obstacle == 4)
+    {
+        blockBlock = true;
+    }
+    else
+    {
+        blockBlock = false;
+    }
+}
+
+//MOBILITY TRANFORM STATES
+//-----------------------------------
+
+bool MobilityCore::CNMTransformCode()
+{
+
+//MUST TEST:  using currentLocation vs using currentMapLocation
+
+   // If returning with a target
+    if (targetCollected && !avoidingObstacle)
+    {
+        RequestScope scope(this, PRIORITY_DROPOFF);
+	if(CNMDropOffCode()) { return false; }
+    }
+
+    //If angle between current and goal is significant
+    //if error in heading is greater than 0.4 radians
+    
+    float distToGoal = hypot(goalLocation.x - currentLocation.x, goalLocation.y - currentLocation.y);
+    
+    if (fabs(angles::shortest_angular_distance(currentLocation.theta, goalLocation.theta)) >
+        rotateOnlyAngleTolerance)
+    {
+        mobilityMachine.dispatch(EVENT_TURN_TO_GOAL, now);
+    }
+
+    //If goal has not yet been reached drive and maintain heading
+    else if (fabs(angles::shortest_angular_distance(currentLocation.theta,
+        atan2(goalLocation.y - currentLocation.y, goalLocation.x - currentLocation.x))) < M_PI_2)
+    {
+        mobilityMachine.dispatch(EVENT_DRIVE_TO_GOAL, now);
+    }
+
+    //Otherwise, drop off target and select new random uniform heading
+    //If no targets have been detected, assign a new goal
+
+    //else if (!targetDetected && timerTimeElapsed > returnToSearchDelay)
+    else if(!targetDetected && distToGoal < 0.5 && timerTimeElapsed > returnToSearchDelay && cnmInitialPositioningComplete)
+    {
+	if(isReversing() || cnmCentering) { CNMReverseReset(); }
+
+        int position;
+        double distance;
+
+        goalLocation = searchController.search(currentLocation);
+
+        position = searchController.cnmGetSearchPosition();
+
+        distance = searchController.cnmGetSearchDistance();
+
+        logEvent(EVENT_TRAVELING, position, distance);
+    }
+
+    return true;
+}
+
+bool MobilityCore::CNMRotateCode()
+{
+
+//MUST TEST:  using currentLocation vs using currentLocationMap
+
+    // If angle > 0.4 radians rotate but dont drive forward.
+    if (fabs(angles::shortest_angular_distance(currentLocation.theta, goalLocation.theta)) > rotateOnlyAngleTolerance)
+    {
+        driveToGoal(true);
+        return true;
+    }
+    else
+    {
+        // move to differential drive step
+        mobilityMachine.dispatch(EVENT_DRIVE_TO_GOAL, now);
+        //fall through on purpose.
+    }
+
+    return false;
+}
+
+void MobilityCore::CNMSkidSteerCode()
+{
+
+//MUST TEST:  Using currentLocation vs currentLocationMap
+
+    DriveCommand command;
+
+    // goal not yet reached or heading still wrong, keep tracking it
+    if (GoalTracker::track(trackGoal(false), currentLocation, command))
+    {
+        driveToGoal(false);
+    }
+    else
+    {
+        // stop
+        sendDriveCommand(0.0, 0.0);
+        avoidingObstacle = false;
+
+        // move back to transform step
+        mobilityMachine.dispatch(EVENT_REPLAN, now);
+    }
+}
+
+TrackGoal MobilityCore::trackGoal(bool rotateFirst)
+{
+    TrackGoal track;
+    track.active = true;
+    track.rotateFirst = rotateFirst;
+    track.goal = goalLocation;
+    track.velocity = searchVelocity;
+    track.rotateOnlyAngleTolerance = rotateOnlyAngleTolerance;
+
+    return track;
+}
+
+void MobilityCore::driveToGoal(bool rotateFirst)
+{
+    // the drive loop will steer towards it at its own rate
+    if (externalGoalTracking)
+    {
+        output.hasTrackGoal = true;
+        output.trackGoal = trackGoal(rotateFirst);
+        trackGoalPriority = requestPriority;
+        return;
+    }
+
+    DriveCommand command;
+    if (GoalTracker::track(trackGoal(rotateFirst), currentLocation, command))
+    {
+        sendDriveCommand(command.linear, command.angular);
+    }
+}
+
+bool MobilityCore::CNMPickupCode()
+{
+
+    PickUpResult result;
+
+//GRIPPER OPTIMUM SETTING:
+//FINGERS:  0 - 2      (Any further and fingers deform[AKA right finger keeps rotating and left doesn't])
+//WRIST:    0 - 1.6    (Any further and will scrape ground if hits bumps)
+
+    // we see a block and have not picked one up yet
+    //CNM ADDED:    AND if we are not doing our reverse behavior
+    if (targetDetected && !targetCollected && !isReversing()  && cnmCanCollectTags)
+    {
+        result = pickUpController.pickUpSelectedTarget(blockBlock, currentLocation);
+        sendDriveCommand(result.cmdVel, result.angleError);
+
+        if (result.fingerAngle != -1)
+        {
+            sendFingerCommand(result.fingerAngle);
+        }
+
+        if (result.wristAngle != -1)
+        {
+            // raise wrist
+            sendWristCommand(result.wristAngle);
+        }
+
+        if (result.giveUp)
+        {
+            logEvent(EVENT_PICKUP_GAVE_UP);
+
+            targetDetected = false;
+            mobilityMachine.dispatch(EVENT_REPLAN, now);
+            sendDriveCommand(0, 0);
+            pickUpController.reset();
+        }
+
+        if (result.pickedUp)
+        {
+            pickUpController.reset();
+
+            // assume target has been picked up by gripper
+            targetCollected = true;
+            result.pickedUp = false;
+
+            //Hand off to rotate
+            mobilityMachine.dispatch(EVENT_TURN_TO_GOAL, now);
+
+            //TEST:  MAP VS ODOM
+
+            goalLocation.theta = atan2(cnmCenterLocation.y - currentLocationMap.y, cnmCenterLocation.x - currentLocationMap.x);
+            //goalLocation.theta = atan2(cnmCenterLocation.y - currentLocation.y, cnmCenterLocation.x - currentLocation.x);
+
+            // set center as goal position
+            goalLocation.x = cnmCenterLocation.x;
+            goalLocation.y = cnmCenterLocation.y;
+
+            //goalLocation.x = centerLocationOdom.x = 0;
+            //goalLocation.y = centerLocationOdom.y;
+
+            // lower wrist to avoid ultrasound sensors
+            sendWristCommand(1.2);  //.8
+            sendDriveCommand(0.0, 0);
+
+            cnmAfterPickUpTimer.start();
+            cnmFinishedPickUp = false;
+
+            return true;
+        }
+    }
+    else
+    {
+        mobilityMachine.dispatch(EVENT_REPLAN, now);
+    }
+
+    return false;
+}
+
+bool MobilityCore::CNMDropOffCode()
+{	
+	bool atCenter = CNMDropoffCalc();
+
+	//if we see the center, drop off (runs in the DROPOFF states from here)
+	if(centerSeen)
+	{
+	    mobilityMachine.dispatch(EVENT_DROP_OFF, now);
+	}
+	
+	//If we are looking for the center
+	else if(searchingForCenter)
+	{
+	    goalLocation = searchController.search(currentLocation);
+	    mobilityMachine.dispatch(EVENT_TURN_TO_GOAL, now);
+	}
+
+	//If we should have found the center by now
+	else if(atCenter && !centerSeen)
+	{
+
+	    logEvent(EVENT_NEST_LOST);
+
+	    //look around where the nest most likely is, and let the next
+	    //sighting count for more than what we thought we knew
+	    searchController.AmILost(true);
+	    searchController.setCenterLocation(nestEstimate.known() ? nestEstimate.getLocation() : currentLocation);
+	    IWasLost = true;
+	    nestEstimate.inflate(CENTERLOSTSD);
+
+	    //Start Looking!
+	    searchingForCenter = true;
+
+	    goalLocation = searchController.search(currentLocation);
+	    mobilityMachine.dispatch(EVENT_TURN_TO_GOAL, now);
+
+	}
+	else
+ 	{
+	    goalLocation = cnmCenterLocation;
+            mobilityMachine.dispatch(EVENT_TURN_TO_GOAL, now);
+            timerStartTime = now;
+	}
+
+    return true;
+
+}
+
+void MobilityCore::CNMDropOffStepCode()
+{
+    switch (mobilityMachine.getCurrent())
+    {
+    //Square up on the nest, then go forward
+    case MOBILITY_DROP_CENTERING:
+    {
+	if(CNMCentered()) { mobilityMachine.dispatch(EVENT_DROP_SQUARED, now); }
+
+	break;
+    }
+
+    //Drive onto the nest until cnmDropOffDriveTimer says we are in position
+    case MOBILITY_DROP_DRIVING_IN:
+    {
+	sendDriveCommand(0.15, 0.0);
+
+	break;
+    }
+
+    //If we THINK we are in a position to drop off a tag
+    case MOBILITY_DROP_CHECKING:
+    {
+	//We drove forward onto the center parallel to the tags... reverse
+	if(perception.nestCount > 8)
+	{				
+            logEvent(EVENT_DROP_TOO_MANY_TAGS);
+
+	    sendDriveCommand(-0.15, 0.0);
+
+	    mobilityMachine.dispatch(EVENT_DROP_BACK_OUT, now);
+	}
+	else if(perception.nestCount > 3 && perception.nestCount <= 8)
+	{
+
+            double turnDirection = 0.0;
+			
+            logEvent(EVENT_DROP_SOME_TAGS);
+
+	    if(perception.nestLeft < (perception.nestRight - 6))
+	    {
+		logEvent(EVENT_DROP_TURN_LEFT, perception.nestLeft, perception.nestRight);
+		turnDirection = 0.15;
+	    }
+	    else if(perception.nestLeft > (perception.nestRight - 6))
+	    {
+		logEvent(EVENT_DROP_TURN_RIGHT, perception.nestLeft, perception.nestRight);
+		turnDirection = -0.15;
+	    }
+	    else if((perception.nestLeft - 6) <= 0 && (perception.nestRight - 6) <= 0)
+	    {
+		logEvent(EVENT_DROP_TAGS_EVEN, perception.nestLeft, perception.nestRight);
+	    }
+
+            sendDriveCommand(0.0, turnDirection);
+	}
+	else
+	{
+            logEvent(EVENT_DROP_FEW_TAGS);
+		
+	    mobilityMachine.dispatch(EVENT_DROP_RELEASE, now);
+	}
+
+	break;
+    }
+
+    //If we drove forward onto the center parallel with the tags and have reversed far enough ... start over
+    case MOBILITY_DROP_BACKING_OUT:
+    {
+	if(perception.nestCount > 5) { sendDriveCommand(-0.15, 0.0); }
+	else { mobilityMachine.dispatch(EVENT_REPLAN, now); }
+
+	break;
+    }
+
+    //DROP AND RESET!
+    case MOBILITY_DROP_RELEASING:
+    {
+        //open fingers all the way
+        sendFingerCommand(2);  //(0-2 is a good range to open and close grippers)
+
+        //raise wrist
+        sendWristCommand(0);
+
+        //If we have dropped our target off successfully
+        timerStartTime = now;
+        targetCollected = false;
+        targetDetected = false;
+        lockTarget = false;
+
+        cnmWaitToReset = true;
+        cnmWaitToResetWGTimer.start();
+
+        cnmCanCollectTags = false;              //Don't try to collect tags
+        cnmWaitToCollectTagsTimer.start();      //Start Timer to trigger back to true
+
+        centerLocationOdom = currentLocation;
+
+        //CNMAVGCenter(currentLocation);
+        CNMAVGCenter(currentLocationMap, CENTERDROPSD);
+
+        // move back to transform step
+        mobilityMachine.dispatch(EVENT_REPLAN, now);
+
+        CNMStartReversing();
+
+        output.hasCycle = true;
+        output.cycle = cycleProfiler.complete(now);
+        logEvent(EVENT_CYCLE_COMPLETE, output.cycle.number, output.cycle.total());
+
+        searchingForCenter = false;
+
+        if(IWasLost)
+        {
+            IWasLost = false;
+            searchController.AmILost(false);
+        }
+
+        break;
+    }
+
+    default:
+    {
+        break;
+    }
+    }
+}
+
+void MobilityCore::CNMEnterDropOff()
+{
+    logEvent(EVENT_DROP_FOUND_CENTER);
+
+    isDroppingOff = true;
+    goalLocation = currentLocation;
+}
+
+void MobilityCore::CNMExitDropOff()
+{
+    isDroppingOff = false;
+    cnmDropOffDriveTimer.stop();
+}
+
+void MobilityCore::CNMEnterDrivingIn()
+{
+    //Once Squared Up, drive in until the timer says we are in position
+    logEvent(EVENT_DROP_SQUARED_UP);
+
+    cnmDropOffDriveTimer.start();
+}
+
+bool MobilityCore::CNMDropoffCalc()
+{
+
+    // calculate the euclidean distance between
+    // centerLocation and currentLocation
+    float distToCenter = hypot(cnmCenterLocation.x - currentLocation.x, cnmCenterLocation.y - currentLocation.y);
+    //float distToCenter = hypot(cnmCenterLocation.x - currentLocationMap.x, cnmCenterLocation.y - currentLocationMap.y);
+
+    float visDistToCenter = 0.5;
+
+    //no point driving closer than the estimate can tell, search from there
+    if(nestEstimate.known()) { visDistToCenter = max(visDistToCenter, (float)(CENTERSEARCHSIGMAS * nestEstimate.uncertainty(now))); }
+
+    if(distToCenter > visDistToCenter) { return false; }
+    else { return true; }
+}
+
+
+//Wrist/Gripper behavior on pickup moved to this utility function
+
+void MobilityCore::CNMTargetPickup(PickUpResult result)
+{
+    //OPEN FINGERS
+    //---------------------------------------------
+    if (result.fingerAngle != -1)
+    {
+        sendFingerCommand(result.fingerAngle);
+    }
+
+    //LOWER WRIST
+    //---------------------------------------------
+    if (result.wristAngle != -1)
+    {
+        sendWristCommand(result.wristAngle);
+    }
+}
+
+//CNM Functions Follow
+//-----------------------------------
+
+//Initial Nest Search
+
+void MobilityCore::CNMFirstBoot()
+{
+    //FIRST TIME IN THIS FUNCTION
+    if(firstTimeInBoot)
+    {
+        //Print a message to the info box letting us know the robot recognizes the state change
+        logEvent(EVENT_AUTONOMOUS_FIRST_BOOT);
+
+        goalLocation = currentLocation;
+
+        firstTimeInBoot = false;
+
+        //START wait, drive forward, turn 180
+        firstBootSequence.start(now);
+
+        //START OBSTACLE DETECTION TIMER
+        cnmTimeBeforeObstDetect.start();
+    }
+
+    //IF WE SEE CENTER, BREAK EVERYTHING
+    if(centerSeen)
+    {
+        cnmFirstBootProtocol = false;
+        cnmInitialPositioningComplete = true;
+
+        firstBootSequence.cancel();
+
+        goalLocation = currentLocation;
+    }
+
+    //OTHERWISE-------
+
+    //Hold still until the initial wait is over, firstBootSequence does the rest
+    else if(!cnmHasWaitedInitialAmount)
+    {
+        sendDriveCommand(0.0, 0.0);
+    }
+}
+
+//Reverse
+
+void MobilityCore::CNMReverseReset()
+{
+    //RESET VARIABLES
+    //---------------------------------------------
+    //infoLog("RESET VARIABLES");
+
+    //leaving BACKING_OFF cancels the reverse sequence
+    reverseMachine.dispatch(EVENT_REVERSE_RESET, now);
+
+    if(cnmCentering)
+    {
+	cnmCentering = false;
+	cnmFinishedCenteringTimer.stop();
+    }
+
+}
+
+void MobilityCore::CNMStartReversing()
+{
+    //Pass Info to Info Log
+    //---------------------------------------------
+//    infoLog("STARTING REVERSE TIMER");
+
+    reverseMachine.dispatch(EVENT_REVERSE_START, now);
+}
+
+void MobilityCore::CNMEnterBackingUp()
+{
+    //Back up, turn 180 and carry on (starts over if we were already turning)
+    //---------------------------------------------
+    reverseSequence.start(now);
+
+    //BACKUP!!!
+    //---------------------------------------------
+    sendDriveCommand(-0.2, 0);
+}
+
+void MobilityCore::CNMExitBackingOff()
+{
+    reverseSequence.cancel();
+}
+
+int MobilityCore::cyclePhase()
+{
+    if (currentMode != 2 && currentMode != 3) { return -1; }
+
+    //recovery and obstacles interrupt whatever else was going on
+    if (isReversing()) { return PHASE_RECOVERY; }
+    if (cnmSeenAnObstacle || cnmAvoidObstacle) { return PHASE_OBSTACLE; }
+
+    if (!targetCollected)
+    {
+        if (mobilityMachine.getCurrent() != MOBILITY_PICKUP) { return PHASE_SEARCHING; }
+
+        return pickUpController.getLockTarget() ? PHASE_GRASP : PHASE_APPROACH;
+    }
+
+    if (mobilityMachine.isIn(MOBILITY_DROPOFF))
+    {
+        return mobilityMachine.getCurrent() == MOBILITY_DROP_CENTERING ? PHASE_CENTERING : PHASE_DROP;
+    }
+    if (cnmCentering) { return PHASE_CENTERING; }
+
+    return PHASE_RETURN;
+}
+
+double MobilityCore::distanceFrom(const geometry_msgs::Pose2D& from)
+{
+    return hypot(currentLocation.x - from.x, currentLocation.y - from.y);
+}
+
+bool MobilityCore::facingGoal(const geometry_msgs::Pose2D& pose)
+{
+    return fabs(angles::shortest_angular_distance(pose.theta, goalLocation.theta)) < rotateOnlyAngleTolerance;
+}
+
+//Target Avoidance
+
+void MobilityCore::CNMTargetAvoid()
+{
+    //if we don't see the center
+    //---------------------------------------------
+    if(!centerSeen)
+    {
+        //if we haven't triggered this behavior
+            //ADDED:  getCenterApproach method to drop off class to get state of dropping off targets
+            //  This was necessary so we don't try to avoid targets when driving in the center
+        //---------------------------------------------
+        if(!cnmAvoidTargets && !dropOffController.getCenterApproach())
+        {
+            //Trigger Bool
+            cnmAvoidTargets = true;
+
+            //Print Message to Info Box
+//            infoLog("Avoiding Blocks; Carrying Target.  Starting Timer");
+
+            if(searchController.cnmIsAlternating()) { goalLocation.theta = currentLocation.theta - (M_PI/6); }
+            else { goalLocation.theta = currentLocation.theta + (M_PI/6); }
+
+            //select new position 25 cm from current location
+            goalLocation.x = currentLocation.x + (AVOIDTARGDIST * cos(goalLocation.theta));
+            goalLocation.y = currentLocation.y + (AVOIDTARGDIST * sin(goalLocation.theta));
+
+            mobilityMachine.dispatch(EVENT_TURN_TO_GOAL, now);
+
+            //START NEW TIMER
+            cnmAvoidOtherTargetTimer.start();
+        }
+
+    }
+}
+
+//Rotation for squaring up on center
+bool MobilityCore::CNMCentered()
+{
+    float linearSpeed, angularSpeed;
+
+    //VARIABLES
+    //-----------------------------------
+    const int amountOfTagsToSee = 8;
+    bool seenEnoughTags = false;
+
+    goalLocation = currentLocation;
+
+    bool right, left;
+
+    if(!isReversing())
+    {
+        if (perception.nestRight > 0) { right = true; }
+        else { right = false; }
+
+        if (perception.nestLeft > 0) { left = true; }
+        else { left = false; }
+
+        if(perception.nestCount > amountOfTagsToSee) { seenEnoughTags = true;}
+        else { seenEnoughTags = false; }
+
+        float turnDirection = 1;
+
+        if (seenEnoughTags) //if we have seen enough tags
+        {
+            if ((perception.nestLeft - 5) > perception.nestRight) //and there are too many on the left
+            {
+            	right = false; //then we say none on the right to cause us to turn right
+            }
+            else if ((perception.nestRight - 5) > perception.nestLeft)
+            {
+            	left = false; //or left in this case
+            }
+
+            //otherwise turn till tags on both sides of image then drive straight
+            if (left && right) { return true; }
+        }
+
+        if (right)
+    	{
+            linearSpeed = 0.15;
+            angularSpeed = -0.35;
+    	}
+        else if (left)
+    	{
+            linearSpeed = -0.15;
+            angularSpeed = 0.35;
+        }
+        else
+        {
+	    if(isDroppingOff) { linearSpeed = 0.35; }
+	    else { linearSpeed = 0.15; }
+	
+	    angularSpeed = 0.0;
+        }
+
+        sendDriveCommand(linearSpeed, angularSpeed);
+    }
+
+    return false;
+
+}
+
+//Seeing Center Behavior
+
+void MobilityCore::CNMFirstSeenCenter()
+{
+    //Create a new location object
+    geometry_msgs::Pose2D location;
+
+    //location = currentLocation;
+    //where we were when the camera saw the nest, not where we are now
+    geometry_msgs::Pose2D seenFrom = perception.map;
+    location = seenFrom;
+
+    //Print out to the screen we found the nest for the first time
+    logEvent(EVENT_NEST_FOUND);
+
+    //change bool
+    cnmLocatedCenterFirst = true;
+    searchController.setCenterSeen(true);
+
+    if(cnmInitialPositioningComplete)
+    {
+        logEvent(EVENT_SEARCH_EXPANDING);
+    }
+
+    geometry_msgs::Pose2D center = CNMCenterSeen();
+    location.x = center.x;
+    location.y = center.y;
+
+    CNMAVGCenter(location, nestFit.valid ? CENTERFITSD : CENTERSIGHTSD);
+
+    CNMStartReversing();
+}
+
+void MobilityCore::CNMRefindCenter()
+{
+    //Create a new location object
+    geometry_msgs::Pose2D location;
+
+    //location = currentLocation;
+    //where we were when the camera saw the nest, not where we are now
+    geometry_msgs::Pose2D seenFrom = perception.map;
+    location = seenFrom;
+
+    //pass search Controller the center point
+        //this is in this statement so it doesn't repeatedly print
+    logEvent(EVENT_NEST_REFOUND);
+
+    geometry_msgs::Pose2D center = CNMCenterSeen();
+    location.x = center.x;
+    location.y = center.y;
+
+    CNMAVGCenter(location, nestFit.valid ? CENTERFITSD : CENTERSIGHTSD);
+
+    CNMStartReversing();
+}
+
+//CNM MAP BUILDING
+
+void MobilityCore::CNMAVGCenter(geometry_msgs::Pose2D newCenter, double sd)
+{   
+
+    //NOTES ON THIS FUNCTION:
+    //- Takes a derived center point and folds it into the nest estimate,
+    //  weighted by how far off that kind of point may be... allowing us to
+    //  build a more dynamic center location (able to adjust with drift)
+
+    logEvent(EVENT_CENTER_AVERAGING);
+
+    double sigmas = nestEstimate.sigmasFrom(newCenter.x, newCenter.y, sd, now);
+
+    NestEstimator::UpdateResult result = nestEstimate.update(newCenter.x, newCenter.y, sd, now);
+
+    if(result == NestEstimator::NEST_REJECTED)
+    {
+        logEvent(EVENT_CENTER_REJECTED, newCenter.x, newCenter.y, sigmas);
+    }
+    else if(result == NestEstimator::NEST_RESTARTED)
+    {
+        logEvent(EVENT_CENTER_RESTARTED, newCenter.x, newCenter.y);
+    }
+
+    //UPDATE CENTER LOCATION
+    //---------------------------------------------
+    cnmCenterLocation = nestEstimate.getLocation();
+
+    //send to searchController
+    //---------------------------------------------
+    searchController.setCenterLocation(cnmCenterLocation);
+}
+
+void MobilityCore::CNMAVGMap()
+{
+
+    //NOTES ON THIS FUNCTION:
+    //-This function will only run once the rover has completed a full
+    // rotation around the octagon and HAS found the center.  At each
+    // point, the rover will collect a GPS and Odom location and blend
+    // them together by averaging them.
+
+    //GPS WINDOW
+    mapCenterStats.add(currentLocationMap);
+
+    //ODOM WINDOW
+    mapOdomStats.add(currentLocation);
+
+    float mapAvgX = mapCenterStats.meanX();
+    float mapAvgY = mapCenterStats.meanY();
+    float odomAvgX = mapOdomStats.meanX();
+    float odomAvgY = mapOdomStats.meanY();
+
+    avgCenterRotation.x = ((mapAvgX + odomAvgX) / 2);
+    avgCenterRotation.y = ((mapAvgY + odomAvgY) / 2);
+}
+
+
+//CNM TIMER FUNCTIONS
+//-----------------------------------
+
+//INITIAL NEST SEARCH STEPS
+
+void MobilityCore::CNMInitPositioning()
+{
+//    infoLog("Initial Wait Time Complete, Driving Forward");
+
+    goalLocation.theta = currentLocation.theta;
+
+    //select position 25 cm from the robots location before attempting to go into search pattern
+    goalLocation.x = currentLocation.x + (.45 * cos(goalLocation.theta));
+    goalLocation.y = currentLocation.y + (.45 * sin(goalLocation.theta));
+
+    cnmHasWaitedInitialAmount = true;
+}
+
+void MobilityCore::CNMForwardInitTimerDone()
+{
+
+//    infoLog("Finished Driving; Turning 180");
+
+    //set NEW heading 180 degrees from current theta
+    goalLocation.theta = currentLocationMap.theta + M_PI;  //was currentLocation
+
+    //APPROX 45 cm away
+    goalLocation.x = currentLocationMap.x + (.45 * cos(goalLocation.theta));  //was currentLocation
+    goalLocation.y = currentLocationMap.y + (.45 * sin(goalLocation.theta));  //was currentLocation
+}
+
+void MobilityCore::CNMInitialWait()
+{
+
+//    infoLog("Finished 180, Starting Search Pattern");
+
+    cnmInitialPositioningComplete = true;
+    cnmFirstBootProtocol = false;
+
+    //Continue an interrupted search pattern
+    //---------------------------------------------
+    goalLocation = searchController.continueInterruptedSearch(currentLocation, goalLocation);
+
+    //ROTATE!!!
+    //---------------------------------------------
+    mobilityMachine.dispatch(EVENT_TURN_TO_GOAL, now);
+
+    int position = searchController.cnmGetSearchPosition();
+
+    double distance = searchController.cnmGetSearchDistance();
+
+    //SPIT OUT NEXT POINT AND HOW FAR OUT WE ARE GOING
+    //---------------------------------------------
+    logEvent(EVENT_TRAVELING, position, distance);
+}
+
+//OBSTACLE TIMERS
+
+void MobilityCore::CNMAvoidObstacle()
+{
+
+    if(centerSeen && targetCollected)
+    {
+        cnmObstacleRearms++;
+        logEvent(EVENT_OBSTACLE_WAITING, cnmObstacleRearms);
+
+        cnmAvoidObstacleTimer.stop();
+        cnmAvoidObstacleTimer.start();
+    }
+    else
+    {
+        logEvent(EVENT_OBSTACLE_AVOIDING);
+
+        cnmObstacleRearms = 0;
+
+        cnmAvoidObstacle = true;
+
+        cnmAvoidObstacleTimer.stop();
+    }
+}
+
+//TARGET AVOIDANCE
+
+void MobilityCore::CNMAvoidOtherTargets()
+{
+    logEvent(EVENT_AVOID_TARGETS_DONE);
+
+    cnmAvoidTargets = false;
+    cnmRotate = false;
+
+    cnmAvoidObstacleTimer.stop();
+
+    if(searchController.cnmIsAlternating()) { goalLocation.theta = currentLocation.theta - (M_PI/6); }
+    else { goalLocation.theta = currentLocation.theta + (M_PI/6); }
+
+    //select new position 25 cm from current location
+    goalLocation.x = currentLocation.x + (AVOIDTARGDIST * cos(goalLocation.theta));
+    goalLocation.y = currentLocation.y + (AVOIDTARGDIST * sin(goalLocation.theta));
+
+    mobilityMachine.dispatch(EVENT_TURN_TO_GOAL, now);
+
+    cnmAvoidOtherTargetTimer.stop();
+}
+
+//REVERSE STEPS
+
+void MobilityCore::CNMReverseTimer()
+{
+//    infoLog("REVERSE TIMER DONE, STARTING TURN180");
+
+    //set NEW heading 180 degrees from current theta
+    goalLocation.theta = currentLocation.theta + M_PI;
+
+    double searchDist = searchController.cnmGetSearchDistance();
+
+    //select position however far away we are currently searching from the robots location before attempting to go into search pattern
+    goalLocation.x = currentLocation.x + (searchDist * cos(goalLocation.theta));
+    goalLocation.y = currentLocation.y + (searchDist * sin(goalLocation.theta));
+
+    //change robot state
+    mobilityMachine.dispatch(EVENT_TURN_TO_GOAL, now);
+
+    //on to TURNING_180
+    reverseMachine.dispatch(EVENT_REVERSE_BACKED_UP, now);
+}
+
+void MobilityCore::CNMTurn180()
+{
+    //Continue an interrupted search pattern
+    //---------------------------------------------
+    goalLocation = searchController.continueInterruptedSearch(currentLocation, goalLocation);
+
+    //ROTATE!!!
+    //---------------------------------------------
+    mobilityMachine.dispatch(EVENT_TURN_TO_GOAL, now);
+
+    int position = searchController.cnmGetSearchPosition();
+
+    double distance = searchController.cnmGetSearchDistance();
+
+    //SPIT OUT NEXT POINT AND HOW FAR OUT WE ARE GOING
+    //---------------------------------------------
+    logEvent(EVENT_TRAVELING, position, distance);
+
+    //back to IDLE, which ends the sequence
+    CNMReverseReset();
+}
+
+//CENTERING TIMERS
+
+void MobilityCore::CNMCenterTimerDone()
+{
+    cnmCentering = false;
+    cnmCenteringFirstTime = true;
+    cnmFinishedCenteringTimer.stop();
+}
+
+//RESET TIMERS
+
+void MobilityCore::cnmWaitToResetWG()
+{
+    cnmWaitToReset = false;
+    cnmWaitToResetWGTimer.stop();
+}
+
+void MobilityCore::cnmFinishedPickUpTime()
+{
+    cnmFinishedPickUp = true;
+    numTagsCarrying = perception.targetCount + 1;
+    //isDroppingOff = true;
+    cnmAfterPickUpTimer.stop();
+}
+
+void MobilityCore::CNMWaitBeforeDetectObst()
+{
+    cnmStartObstDetect = true;
+    cnmTimeBeforeObstDetect.stop();
+}
+
+void MobilityCore::CNMWaitToCollectTags()
+{
+    cnmCanCollectTags = true;
+    cnmWaitToCollectTagsTimer.stop();
+}
+
+void MobilityCore::CNMCenterGPS()
+{
+    centerGPSStats.add(CNMCenterSeen());
+}
+
+geometry_msgs::Pose2D MobilityCore::CNMCenterSeen()
+{
+    //the map pose the rover had when the camera saw the nest
+    double normCurrentAngle = angles::normalize_angle_positive(perception.map.theta);
+
+    geometry_msgs::Pose2D center;
+    center.theta = normCurrentAngle;
+
+    //the tags' own layout places the center from any angle
+    if(nestFit.valid)
+    {
+        center.x = nestFit.x;
+        center.y = nestFit.y;
+        return center;
+    }
+
+    //otherwise assume we are squared up and it is straight ahead
+    center.x = perception.map.x + (CENTEROFFSET * (cos(normCurrentAngle)));
+    center.y = perception.map.y + (CENTEROFFSET * (sin(normCurrentAngle)));
+
+    return center;
+}
+
+void MobilityCore::CNMAVGCenterGPS()
+{
+    geometry_msgs::Pose2D gpsCenter = centerGPSStats.mean();
+
+    //only trust the points if they agree with each other
+    if(centerGPSStats.standardError() <= CENTERMAXSTDERR) { CNMAVGCenter(gpsCenter, hypot(CENTERGPSSD, centerGPSStats.standardError())); }
+    else
+    {
+        logEvent(EVENT_CENTER_DISAGREE, centerGPSStats.standardError());
+    }
+
+    //start a fresh set of points for the next time we square up
+    centerGPSStats.clear();
+}
+
+void MobilityCore::CNMDropOffDrive()
+{
+
+    cnmDropOffDriveTimer.stop();
+
+    if(seeMoreTargets)
+    {
+        logEvent(EVENT_DROP_MORE_TAGS);
+
+        mobilityMachine.dispatch(EVENT_DROP_RELEASE, now);
+    }
+    else { mobilityMachine.dispatch(EVENT_DROP_DRIVEN_IN, now); }
+
+}
+
+void MobilityCore::CNMDropTimedOut()
+{
+    goalLocation = cnmCenterLocation;
+    cnmDropOffTimeOut.stop();
+}
@@ -0,0 +1,641 @@
+#ifndef MOBILITYCORE_H
+#define MOBILITYCORE_H
+
+#include <string>
+#include <vector>
+
+#include <geometry_msgs/Pose2D.h>
+#include <apriltags_ros/AprilTagDetectionArray.h>
+
+#include "PickUpController.h"
+#include "DropOffController.h"
+#include "SearchController.h"
+#include "WindowedStats.h"
+#include "GoalTracker.h"
+#include "ActuatorArbiter.h"
+#include "HierarchicalStateMachine.h"
+#include "Sequence.h"
+#include "EventLog.h"
+#include "CycleProfiler.h"
+#include "PerceptionFrame.h"
+#include "NestFit.h"
+#include "NestEstimator.h"
+#include "PoseHistory.h"
+#include "Clock.h"
+#include "TimerWheel.h"
+
+/**
+ * The rover behaviour (the mobility state machine and everything it calls)
+ * without any ROS publishers, subscribers or timers.  Everything the rover
+ * senses goes in through a MobilityInput and everything it wants to do comes
+ * back out in a MobilityOutput, so the same logic can run under the mobility
+ * node or be driven as fast as the CPU allows by a test or replay harness.
+ *
+ * Time only ever comes from MobilityInput::time (the controllers read the
+ * core's StepClock, set to it every step).  The only clock the core reads
+ * is the wall time the state machines put on their transition trace as its
+ * cost, which never feeds back into what the rover does.
+ */
+
+// STATE MACHINE STATE CONSTANTS (for mobility SWITCH)
+//--------------------------------------------
+#define STATE_MACHINE_TRANSFORM 0
+#define STATE_MACHINE_ROTATE 1
+#define STATE_MACHINE_SKID_STEER 2
+#define STATE_MACHINE_PICKUP 3
+#define STATE_MACHINE_DROPOFF 4
+
+// States of the mobility HierarchicalStateMachine, keeping the numbers of
+// the STATE_MACHINE_* states above (DROPOFF is the parent of the DROP_*
+// leaves)
+enum MobilityState {
+    MOBILITY_TRANSFORM = STATE_MACHINE_TRANSFORM,
+    MOBILITY_ROTATE = STATE_MACHINE_ROTATE,
+    MOBILITY_SKID_STEER = STATE_MACHINE_SKID_STEER,
+    MOBILITY_PICKUP = STATE_MACHINE_PICKUP,
+    MOBILITY_DROPOFF = STATE_MACHINE_DROPOFF,   // DROP_CENTERING .. DROP_RELEASING
+    MOBILITY_NAVIGATING,                        // TRANSFORM, ROTATE and SKID_STEER
+    MOBILITY_AUTONOMOUS,                        // root
+    MOBILITY_DROP_CENTERING,                    // square up on the nest
+    MOBILITY_DROP_DRIVING_IN,                   // drive onto it until cnmDropOffDriveTimer
+    MOBILITY_DROP_CHECKING,                     // line up on the nest tags still in view
+    MOBILITY_DROP_BACKING_OUT,                  // drove in along an edge, back out
+    MOBILITY_DROP_RELEASING,                    // let go of the block
+    MOBILITY_STATES
+};
+
+enum MobilityEvent {
+    EVENT_REPLAN,                               // -> TRANSFORM, pick (or keep) a goal
+    EVENT_TURN_TO_GOAL,                         // -> ROTATE
+    EVENT_DRIVE_TO_GOAL,                        // -> SKID_STEER, only while navigating
+    EVENT_PICK_UP,                              // -> PICKUP
+    EVENT_DROP_OFF,                             // -> DROP_CENTERING, nest in view with a block
+    EVENT_DROP_SQUARED,                         // -> DROP_DRIVING_IN
+    EVENT_DROP_DRIVEN_IN,                       // -> DROP_CHECKING
+    EVENT_DROP_BACK_OUT,                        // -> DROP_BACKING_OUT
+    EVENT_DROP_RELEASE,                         // -> DROP_RELEASING
+    MOBILITY_EVENTS
+};
+
+// Back up, turn around and carry on searching (after dropping off, seeing
+// the nest while hunting for targets, ...)
+enum ReverseState {
+    REVERSE_ROOT,
+    REVERSE_IDLE,
+    REVERSE_BACKING_OFF,                        // BACKING_UP and TURNING_180
+    REVERSE_BACKING_UP,
+    REVERSE_TURNING_180,
+    REVERSE_STATES
+};
+
+enum ReverseEvent {
+    EVENT_REVERSE_START,
+    EVENT_REVERSE_BACKED_UP,
+    EVENT_REVERSE_RESET,
+    REVERSE_EVENTS
+};
+
+// The sensor inputs whose age the core keeps track of
+enum InputSlot {
+    SLOT_ODOMETRY,
+    SLOT_MAP,
+    SLOT_OBSTACLE,
+    SLOT_TARGETS,
+    INPUT_SLOTS
+};
+
+//When a sensor input was measured and when the node got it, seconds on the
+//MobilityInput::time clock.  0 means input.time (no better idea).
+struct InputTimes {
+    InputTimes() : stamp(0), received(0) {}
+
+    double stamp;                               // header stamp of the message
+    double received;                            // when its callback ran
+};
+
+//Everything that happened since the last step.  Only the fields with their
+//has* flag set are looked at.
+struct MobilityInput {
+    MobilityInput() : time(0), hasMode(false), mode(0), hasJoystick(false), joyLinear(0), joyAngular(0),
+        hasOdometry(false), hasMap(false), hasObstacle(false), obstacle(0), hasTargets(false), tick(false) {}
+
+    double time;                                // seconds, must never go backwards
+
+    bool hasMode;
+    int mode;                                   // 0/1 manual, 2/3 autonomous
+
+    bool hasJoystick;
+    double joyLinear;                           // axes[4] of the joystick
+    double joyAngular;                          // axes[3] of the joystick
+
+    bool hasOdometry;
+    geometry_msgs::Pose2D odometry;             // odom frame pose
+
+    bool hasMap;
+    geometry_msgs::Pose2D map;                  // map frame (GPS fused) pose
+
+    bool hasObstacle;
+    int obstacle;                               // 0 none, 1 right, 2 front/left, 4 block in the claw
+
+    bool hasTargets;
+    apriltags_ros::AprilTagDetectionArray::ConstPtr targets;
+
+    InputTimes times[INPUT_SLOTS];              // for the sensor inputs that are set
+
+    bool tick;                                  // run one iteration of the state machine
+};
+
+//A StepTimer starting, firing or being stopped (see setTimerTracing)
+struct TimerMark {
+    enum Action { STARTED, FIRED, STOPPED };
+
+    const char* timer;                          // name of the timer member, lives as long as the core
+    int action;
+};
+
+//What the core wants done after one step.  The ActuatorArbiter has already
+//picked at most one command per actuator.
+struct MobilityOutput {
+    void clear()
+    {
+        drive.clear();
+        fingerAngles.clear();
+        wristAngles.clear();
+        events.clear();
+        timerMarks.clear();
+        hasStateName = false;
+        hasTrackGoal = false;
+        hasCycle = false;
+    }
+
+    std::vector<DriveCommand> drive;
+    std::vector<float> fingerAngles;
+    std::vector<float> wristAngles;
+    std::vector<Event> events;                  // what used to go to /infoLog, see EventLog
+    std::vector<TimerMark> timerMarks;          // only with setTimerTracing(true)
+
+    bool hasStateName;                          // set on ticks, the state shown to the operator
+    std::string stateName;
+
+    bool hasTrackGoal;                          // only with setExternalGoalTracking(true), hand trackGoal to the drive loop
+    TrackGoal trackGoal;
+
+    bool hasCycle;                              // a target was just dropped, cycle is how the delivery went
+    CycleRecord cycle;
+};
+
+class MobilityCore
+{
+public:
+    MobilityCore();
+
+    // Feeds one batch of inputs through the handlers, fires any timers that
+    // came due and, if input.tick is set, runs the state machine.  The
+    // returned reference stays valid until the next call.
+    const MobilityOutput& step(const MobilityInput& input);
+
+    // With external goal tracking the ROTATE and SKID_STEER states don't
+    // drive themselves, they hand a TrackGoal out for a faster loop running
+    // a GoalTracker to follow.
+    void setExternalGoalTracking(bool external) { externalGoalTracking = external; }
+
+    // Report every timer start, fire and stop in MobilityOutput::timerMarks
+    void setTimerTracing(bool trace);
+
+    // An input older than maxAge seconds (by its stamp) is stale: a camera
+    // frame that old is thrown away unread, and while a slot stays stale the
+    // rover stops acting on what it last said.  0 never goes stale.
+    void setMaxAge(int slot, double maxAge) { freshness[slot].maxAge = maxAge; }
+    double getMaxAge(int slot) { return freshness[slot].maxAge; }
+
+    double getInputAge(int slot);                   // seconds since the stamp of the newest input, -1 before the first
+    double getInputDelay(int slot) { return freshness[slot].delay; }    // received - stamp of the newest input
+    bool isInputStale(int slot) { return freshness[slot].stale; }
+    unsigned long getStaleFramesDropped() { return staleFramesDropped; }
+
+    int getStateMachineState() { return mobilityMachine.isIn(MOBILITY_DROPOFF) ? STATE_MACHINE_DROPOFF : mobilityMachine.getCurrent(); }
+    int getCurrentMode() { return currentMode; }
+    bool isInitialized() { return init; }
+    double getTime() { return now; }
+
+    geometry_msgs::Pose2D getCurrentLocation() { return currentLocation; }
+    geometry_msgs::Pose2D getCurrentLocationMap() { return currentLocationMap; }
+    geometry_msgs::Pose2D getGoalLocation() { return goalLocation; }
+    geometry_msgs::Pose2D getCenterLocationMap() { return centerLocationMap; }
+    geometry_msgs::Pose2D getNestLocation() { return cnmCenterLocation; }
+    const NestEstimator& getNestEstimate() { return nestEstimate; }
+
+    // for profiling, the machines keep a trace of their last transitions
+    const HierarchicalStateMachine<MobilityCore>& getMobilityMachine() { return mobilityMachine; }
+    const HierarchicalStateMachine<MobilityCore>& getReverseMachine() { return reverseMachine; }
+
+private:
+
+    // One shot timer run off the time handed to step().  Behaves like the
+    // ros::Timer it replaces: start() on a started timer does nothing, and a
+    // timer that fired stays started until stop() is called.  Deadlines are
+    // kept in the core's TimerWheel, which decides what fires when.
+    class StepTimer
+    {
+    public:
+        StepTimer() : clock(0), wheel(0), id(0), period(0), deadline(0), started(false), fired(false), callback(0), name(""), marks(0) {}
+
+        void setup(const StepClock* clock, double period, void (MobilityCore::*callback)(), const char* name)
+        {
+            this->clock = clock;
+            this->period = (int64_t)(period * 1e9 + 0.5);
+            this->callback = callback;
+            this->name = name;
+        }
+
+        void attach(TimerWheel* wheel, unsigned int id)
+        {
+            this->wheel = wheel;
+            this->id = id;
+        }
+
+        void setMarks(std::vector<TimerMark>* marks) { this->marks = marks; }
+
+        void start()
+        {
+            if (started) { return; }
+
+            started = true;
+            fired = false;
+            deadline = clock->nanoseconds() + period;
+            wheel->schedule(id, deadline);
+            mark(TimerMark::STARTED);
+        }
+
+        void stop()
+        {
+            if (started)
+            {
+                wheel->cancel(id);
+                mark(TimerMark::STOPPED);
+            }
+
+            started = false;
+        }
+
+        bool due() const { return started && !fired && clock->nanoseconds() >= deadline; }
+
+        void fire(MobilityCore* core)
+        {
+            fired = true;
+            mark(TimerMark::FIRED);
+            (core->*callback)();
+        }
+
+    private:
+        void mark(int action)
+        {
+            if (!marks) { return; }
+
+            TimerMark timerMark;
+            timerMark.timer = name;
+            timerMark.action = action;
+            marks->push_back(timerMark);
+        }
+
+        const StepClock* clock;
+        TimerWheel* wheel;
+        unsigned int id;                            // index in timers
+        int64_t period;                             // nanoseconds
+        int64_t deadline;
+        bool started;
+        bool fired;
+        void (MobilityCore::*callback)();
+        const char* name;
+        std::vector<TimerMark>* marks;              // NULL unless timers are traced
+    };
+
+    //Handlers (what used to be the ROS callbacks)
+    //--------------------------------------------
+    void mobilityStateMachine();
+    void targetHandler(const apriltags_ros::AprilTagDetectionArray::ConstPtr& message, double stamp);
+    void modeHandler(int mode);
+    void obstacleHandler(int obstacle);
+    void joyCmdHandler(double linear, double angular);
+    void targetDetectedReset();
+
+    double inputStamp(const MobilityInput& input, int slot);    //when the input was measured
+    bool takeInput(int slot, const InputTimes& times);     //notes the input's times, false if it is older than the last one or too old to use
+    void checkFreshness();                          //stale/fresh transitions, once a tick
+    void holdStillIfBlind();                        //no drive without a current odometry
+
+    void addTimer(StepTimer& timer);
+    void fireDueTimers();
+
+    // Everything asked of the actuators while one of these is alive is
+    // requested at its priority
+    class RequestScope
+    {
+    public:
+        RequestScope(MobilityCore* core, ActuatorPriority priority) : core(core), previous(core->requestPriority)
+        {
+            core->requestPriority = priority;
+        }
+
+        ~RequestScope() { core->requestPriority = previous; }
+
+    private:
+        MobilityCore* core;
+        ActuatorPriority previous;
+    };
+
+    //Outputs (requests to the arbiter)
+    //--------------------------------------------
+    void sendDriveCommand(double linearVel, double angularVel);
+    void sendFingerCommand(float angle);
+    void sendWristCommand(float angle);
+    void logEvent(EventId id, double a = 0, double b = 0, double c = 0);
+
+    void mapAverage();                              // constantly averages last positions from map
+
+    //CNM moved ORIGINAL CODE to utility functions
+    //---------------------------------------------
+    bool CNMTransformCode();                        //A function for the Transform segment in Mobility State Machine
+                                                    //	- returns true only if it needs to return
+    bool CNMPickupCode();                           //A function for PickUpController in Mobility State Machine
+                                                    //	- returns false if it needs to break
+    bool CNMRotateCode();                           //A function for the Rotate Mobility State Machine Code
+
+    void CNMSkidSteerCode();                        //A function with all the skid steer mobility code
+
+    TrackGoal trackGoal(bool rotateFirst);          //goalLocation as something the GoalTracker can follow
+    void driveToGoal(bool rotateFirst);             //steer towards goalLocation, or have the drive loop do it
+
+    bool CNMDropOffCode();                          //CNM ADDED:  More Controll over Drop Off
+    void CNMDropOffStepCode();                      //One tick of whichever DROPOFF sub-state we are in
+    void CNMEnterDropOff();                         //mobilityMachine entry/exit actions
+    void CNMExitDropOff();
+    void CNMEnterDrivingIn();
+    bool CNMDropoffCalc();
+
+    void CNMFirstBoot();                            //Code for robot to run on initial switch to autonomous mode
+
+    //NEW REVERSE ATTEMPT
+    void CNMStartReversing();                       //Begins Reverse Timers
+    void CNMReverseReset();                         //Resets Reverse Variables
+    bool isReversing() { return reverseMachine.isIn(REVERSE_BACKING_OFF); }
+
+    void CNMEnterBackingUp();                       //reverseMachine entry/exit actions
+    void CNMExitBackingOff();
+
+    int cyclePhase();                               //which CyclePhase the rover is in, -1 when not autonomous
+
+    double distanceFrom(const geometry_msgs::Pose2D& from);     //how far currentLocation is from a pose
+    bool facingGoal(const geometry_msgs::Pose2D& pose);         //pose within rotateOnlyAngleTolerance of goalLocation.theta
+
+    void CNMFirstSeenCenter();                      //Initial Center Find Code
+    void CNMRefindCenter();                         //Refind Center Code
+
+    void CNMTargetPickup(PickUpResult result);      //Wrist/Gripper Setting on pickup
+
+    void CNMTargetAvoid();                          //Code To Avoid Targets
+
+    bool CNMCentered();                             //Squares Rover up on nest when found
+
+    void CNMAVGCenter(geometry_msgs::Pose2D newCenter, double sd);  //Folds a derived center location (sd meters) into the estimate
+
+    void CNMAVGMap();                               //Averages GPS AND ODOM points around the octagon
+
+    void CNMCenterGPS();                            //When we see center, we start storing GPS locations
+    geometry_msgs::Pose2D CNMCenterSeen();          //Nest center from the last frame, fitted or straight ahead
+    void CNMAVGCenterGPS();
+
+    //Timer Functions/Callbacks Handlers
+    //-----------------------------------
+
+    //INITIAL NEST SEARCH (firstBootSequence steps)
+    void CNMInitPositioning();                      //After the initial wait, Drive Forward
+    void CNMForwardInitTimerDone();                 //Done driving forward, Turn 180
+    void CNMInitialWait();                          //Done turning, Continue Search
+
+    //TIMER FOR SQUARING UP ON NEST
+    void CNMCenterTimerDone();                      //Timer before telling rover it has finished squaring up on nest
+
+    //PICKUP TIMERS/DROP OFF TIMERS
+    void cnmFinishedPickUpTime();                   //Wait before detecting other tags to avoid
+    void cnmWaitToResetWG();                        //After Dropping off, wait before resetting grippers
+
+    void CNMDropOffDrive();                         //Timer to drive forward before drop off attempt in center
+    void CNMDropTimedOut();
+
+    //REVERSE (reverseSequence steps)
+    void CNMReverseTimer();                         //Done reversing, Turn 180
+    void CNMTurn180();                              //Done turning, Continue Search
+
+    //Obstacle Avoidance Timer
+    void CNMAvoidObstacle();                        //Timer Function(when timer fires, it runs this code)
+    void CNMWaitBeforeDetectObst();                 //When called, triggers cnmStartObstDetect to true, allowing rover to start avoiding obstacles
+
+    void CNMWaitToCollectTags();                    //Handler triggers state to start collecting targets again
+
+    //Target Avoidance Timer
+    void CNMAvoidOtherTargets();
+
+    // Variables
+    //--------------------------------------------
+    double now;                                     // time of the step being run
+    StepClock clock;                                // now, for the controllers
+    bool firstStep;
+    MobilityOutput output;
+    bool externalGoalTracking;                      // a separate drive loop follows the goals
+
+    ActuatorArbiter arbiter;
+    ActuatorPriority requestPriority;               // who is asking, see RequestScope
+    ActuatorPriority trackGoalPriority;             // who handed out output.trackGoal
+
+    HierarchicalStateMachine<MobilityCore> mobilityMachine;     //current state in mobility state machine
+    HierarchicalStateMachine<MobilityCore> reverseMachine;      //reverse/turn 180 behaviour
+
+    //GEOMETRY_MSG::POSE2D CLASS OBJECTS            //x, y, theta public variables (vectors)
+    //--------------------------------------------
+    geometry_msgs::Pose2D currentLocation;          //current location of robot
+    geometry_msgs::Pose2D currentLocationMap;       //current location on MAP
+    geometry_msgs::Pose2D currentLocationAverage;   //average of the last mapHistorySize map locations
+    geometry_msgs::Pose2D goalLocation;             //location to drive to
+
+    geometry_msgs::Pose2D centerLocationMap;        //location of center on map
+    geometry_msgs::Pose2D centerLocationOdom;       //location of center ODOM
+
+    WindowedStats mapLocationStats;                 //running average of the last mapHistorySize map positions
+
+    PoseHistory odometryHistory;                    //recent currentLocations by measurement time
+    PoseHistory mapHistory;                         //recent currentLocationMaps by measurement time
+
+    //Controller Class Objects
+    //--------------------------------------------
+    PickUpController pickUpController;
+    DropOffController dropOffController;
+    SearchController searchController;
+
+    int currentMode;
+    bool targetDetected;                            //for target detection    (seen a target)
+    bool targetCollected;                           //for target collection   (picked up a target)
+    bool avoidingObstacle;
+
+    // Set true when the target block is less than targetDist so we continue
+    // attempting to pick it up rather than switching to another block in view.
+    bool lockTarget;
+
+    // Set to true when the center ultrasound reads less than 0.14m. Usually means
+    // a picked up cube is in the way.
+    bool blockBlock;
+
+    // Set true when we are insie the center circle and we need to drop the block,
+    // back out, and reset the boolean cascade.
+    bool reachedCollectionPoint;
+
+    // used for calling code once but not in main
+    bool init;
+
+    double timerStartTime;                          // records time for delays in sequanced actions
+    double startDelayInSeconds;                     // An initial delay to allow the rover to gather enough position data to
+                                                    // average its location.
+    float timerTimeElapsed;
+
+    //CNM Code Follows:
+    //--------------------------------------------
+
+    //WINDOWS FOR CENTER
+
+    //Actual Center (every derived center point, weighted by how sure it is)
+    NestEstimator nestEstimate;
+
+    //Center points derived each time we see the nest while squaring up
+    WindowedStats centerGPSStats;
+
+    //GPS Points from across the octagon
+    WindowedStats mapCenterStats;
+
+    //ODOM Points from across the octagon
+    WindowedStats mapOdomStats;
+
+    geometry_msgs::Pose2D cnmCenterLocation;        //AVG Center Location spit out by AVGCenter
+    geometry_msgs::Pose2D avgCenterRotation;        //AVG Center of the octagon rotation
+
+    //Target Collection Variables
+    //--------------------------------------------
+    float searchVelocity;                           // meters/second
+
+    float rotateOnlyAngleTolerance;
+    int returnToSearchDelay;
+
+    //NEST INFORMATION
+
+    bool centerSeen;                                //If we CURRENTLY see the center
+    bool cnmHasCenterLocation;                      //If we have a center/nest location at all
+    bool cnmLocatedCenterFirst;                     //If this is the first time we have seen the nest
+
+    //FINDING NEST BEHAVIOR
+
+    bool cnmCenteringFirstTime;                     //First time entering the Centering function
+    bool cnmCentering;                              //If we are trying to Center the rover
+
+    //INITIAL NEST SEARCH
+
+    bool cnmFirstBootProtocol;
+    bool cnmHasWaitedInitialAmount;
+    bool cnmInitialPositioningComplete;
+
+    //What the last camera frame showed (nest and target tag counts, the
+    //nearest target, ...), cleared when the frame is not to be acted on
+
+    PerceptionFrame perception;
+    NestFit nestFit;                                //the nest square fitted to that frame's nest tags
+
+    //Variables for Obstacle Avoidance
+
+    bool cnmAvoidObstacle;
+    int cnmObstacleRearms;                          //Times the avoid timer was restarted while waiting at the nest
+    bool cnmSeenAnObstacle;
+    bool cnmStartObstDetect;
+    bool cnmCanCollectTags;                         //Tells the rover if it can collect tags based on if it is avoiding an obst
+
+    //Variables for PickUp
+
+    bool cnmFinishedPickUp;
+    bool cnmWaitToReset;
+    int numTagsCarrying;
+
+    //Variables for DropOff
+
+    bool isDroppingOff;
+    bool seeMoreTargets;
+
+    //Variable for avoiding targets when carrying a target
+    bool cnmAvoidTargets;
+    bool cnmRotate;
+
+    //What used to be function statics
+    //---------------------------------------------
+
+    //CNMFirstBoot
+    bool firstTimeInBoot;
+
+    //obstacleHandler
+    bool firstTimeRotate;
+    bool firstTimeSeeObst;
+
+    //CNMDropOffCode
+    bool IWasLost;
+    bool searchingForCenter;
+
+    //Behaviour Sequences (stepped with the state machine)
+    //---------------------------------------------
+    Sequence firstBootSequence;                     //Waits, Drives Forward, Turns 180 and continues search
+    Sequence reverseSequence;                       //Backs up, Turns 180 and continues search (runs while BACKING_OFF)
+    geometry_msgs::Pose2D firstBootMark;            //where the current firstBootSequence step began
+    geometry_msgs::Pose2D reverseMark;              //where the current reverseSequence step began
+
+    //Obstacle Avoidance Timers
+    //---------------------------------------------
+    StepTimer cnmAvoidObstacleTimer;                //Waits 10 Seconds before beginning to turn away from targets
+    StepTimer cnmTimeBeforeObstDetect;              //Waits before allowing the rovers to start looking for OBST. ONLY RAN ONCE AT START UP!
+    StepTimer cnmWaitToCollectTagsTimer;            //Waits after Obstacle or target is dropped off to pick up targets
+
+    //Target Avoidance Timers
+    //---------------------------------------------
+    StepTimer cnmAvoidOtherTargetTimer;
+
+    //Reset Timers
+    //---------------------------------------------
+    StepTimer cnmWaitToResetWGTimer;
+
+    //DropOff Timers
+    //---------------------------------------------
+    StepTimer cnmDropOffDriveTimer;
+    StepTimer cnmDropOffTimeOut;
+
+    //Centering Timer (used to center rover and find more accurate point to
+        //translate centers position to
+    //---------------------------------------------
+    StepTimer cnmFinishedCenteringTimer;
+    StepTimer cnmAfterPickUpTimer;
+
+    //every timer above, by id in timerWheel
+    std::vector<StepTimer*> timers;
+    TimerWheel timerWheel;                          //deadlines of all of them, keyed on step time
+    std::vector<unsigned int> dueTimers;            //scratch for fireDueTimers
+
+    CycleProfiler cycleProfiler;                    //times the phases of every delivery
+
+    //How old every sensor input is
+    //---------------------------------------------
+    struct InputFreshness {
+        InputFreshness() : stamp(0), delay(0), maxAge(0), stale(false) {}
+
+        double stamp;                               //stamp of the newest input, 0 before the first
+        double delay;                               //how long it took to reach the node
+        double maxAge;
+        bool stale;
+    };
+
+    InputFreshness freshness[INPUT_SLOTS];
+    unsigned long staleFramesDropped;               //camera frames too old to act on
+};
+
+#endif // MOBILITYCORE_H
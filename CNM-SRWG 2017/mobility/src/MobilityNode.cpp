@@ -0,0 +1,1153 @@
+#include "MobilityNode.h"
+
+#include <sstream>
+#include <fstream>
+
+#include <std_msgs/Float32.h>
+#include <std_msgs/String.h>
+#include <geometry_msgs/Twist.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
+#include <cmath>
+
+using namespace std;
+
+static const unsigned int lockstepBacklog = 256;                 // sensor messages held per topic waiting for their step
+
+static const char* latencyStateNames[] = { "TRANSFORM", "ROTATE", "SKID_STEER", "PICKUP", "DROPOFF" };
+static const char* latencySourceNames[] = { "odometry", "targets", "obstacle" };
+static const char* timerActionNames[] = { "start", "fire", "stop" };
+static const char* inputSlotNames[] = { "odometry", "map", "obstacle", "targets" };
+
+// Queued on controlQueue by the perception thread to step the core on
+// whatever it just stored
+class MobilityNode::ControlWake : public ros::CallbackInterface
+{
+public:
+    ControlWake(MobilityNode* node) : node(node) {}
+
+    virtual CallResult call()
+    {
+        node->controlWake();
+        return Success;
+    }
+
+private:
+    MobilityNode* node;
+};
+
+// Queued ahead of everything else on a control critical queue, so the thread
+// spinning it makes itself real time before it runs anything
+class MobilityNode::RealTimeSetup : public ros::CallbackInterface
+{
+public:
+    RealTimeSetup(const RealTimeConfig& config, const char* thread) : config(config), thread(thread) {}
+
+    virtual CallResult call()
+    {
+        string error;
+        if (makeThreadRealTime(config, error))
+        {
+            ROS_INFO("Mobility %s thread running SCHED_FIFO at priority %d", thread, config.priority);
+        }
+        else
+        {
+            ROS_WARN("Could not make the mobility %s thread real time (%s)", thread, error.c_str());
+        }
+
+        return Success;
+    }
+
+private:
+    RealTimeConfig config;
+    const char* thread;
+};
+
+MobilityNode::MobilityNode(ros::NodeHandle& mNH, ros::NodeHandle& privateNH, string publishedName, bool lockMemory) : cycleStats(cycleWindow)
+{
+    this->publishedName = publishedName;
+
+    mobilityLoopTimeStep = 0.1;
+    status_publish_interval = 1;
+    mapToOdomMaxAge = 2.0;
+    centerLocationValid = false;
+    reportedStale = false;
+    driveSpinner = NULL;
+    perceptionSpinner = NULL;
+    poseSpinner = NULL;
+    controlSpinner = NULL;
+    odometrySeen = 0;
+    mapSeen = 0;
+    flightRecorder = NULL;
+    controlWatchdog = NULL;
+    controlStalled = false;
+    controlStops = 0;
+    reportedOverruns = 0;
+    reportedMissed = 0;
+    reportedStops = 0;
+    controlTrace = NULL;
+    perceptionTrace = NULL;
+    poseTrace = NULL;
+    driveTrace = NULL;
+    mobilityTransitionsSeen = 0;
+    reverseTransitionsSeen = 0;
+    controlWakePending = false;
+
+    latencyReportInterval = 5;
+    latencyState = -1;
+    for (int i = 0; i < LATENCY_SOURCES; i++) { sourceStamp[i] = 0; }
+
+    //Hz the drive thread steers towards the last planned goal at, 0 leaves it to the core
+    privateNH.param("drive_loop_rate", driveLoopRate, 50.0);
+
+    //step once per /clock message on sim time, sensors held until their stamp
+    privateNH.param("lockstep", lockstep, false);
+
+    //LOCKSTEP (simulation stepped by /clock)
+    //----------------------------------------------------
+    //everything the rover decides happens in /clock steps, on sim time
+    clock = &rosClock;
+    lockstepPeriod = (int64_t)llround(mobilityLoopTimeStep * 1e3) * 1000000;
+    nextLockstepTick = 0;
+
+    if (lockstep)
+    {
+        clock = &lockstepClock;
+        driveLoopRate = 0;
+    }
+
+    bool realTime;
+    RealTimeConfig realTimeConfig;
+    //lock memory (when the process is ours) and run the control and drive
+    //threads SCHED_FIFO at realtime_priority, pinned to realtime_cpu when it is set
+    privateNH.param("realtime", realTime, false);
+    privateNH.param("realtime_priority", realTimeConfig.priority, realTimeConfig.priority);
+    privateNH.param("realtime_cpu", realTimeConfig.cpu, realTimeConfig.cpu);
+
+    if (realTime && lockMemory)
+    {
+        string error;
+        if (!lockProcessMemory(error)) { ROS_WARN("Could not lock the mobility node in memory (%s)", error.c_str()); }
+    }
+
+    string recordPath;
+    //file every MobilityInput is recorded to for replay, empty for none
+    privateNH.param("record_inputs", recordPath, string(""));
+
+    string eventLogPath;
+    double infoLogRate;
+    //every EventLog event goes to event_log, at most info_log_rate a second to /infoLog
+    privateNH.param("event_log", eventLogPath, publishedName + "_mobility.events");
+    privateNH.param("info_log_rate", infoLogRate, 5.0);
+
+    double flightSeconds;
+    string flightPrefix;
+    //seconds of inputs and outputs kept, dumped to flight_dump_prefix files when something goes wrong
+    privateNH.param("flight_recorder_seconds", flightSeconds, 30.0);
+    privateNH.param("flight_dump_prefix", flightPrefix, publishedName + "_mobility_dump");
+
+    //per state command latencies, written at shutdown
+    privateNH.param("latency_csv", latencyCsvPath, publishedName + "_mobility_latency.csv");
+
+    int stopAfterMissed;
+    //control periods without a tick before the wheels are stopped, 0 never
+    privateNH.param("overrun_stop_after", stopAfterMissed, 3);
+    controlWatchdog = new LoopWatchdog(mobilityLoopTimeStep, stopAfterMissed);
+
+    //how old (seconds) each sensor input may get before the rover stops acting on it, 0 never
+    for (int slot = 0; slot < INPUT_SLOTS; slot++)
+    {
+        double maxAge;
+        privateNH.param(string("max_age_") + inputSlotNames[slot], maxAge, core.getMaxAge(slot));
+        core.setMaxAge(slot, maxAge);
+    }
+
+    string tracePath;
+    //Trace Event Format timeline of callbacks, steps, transitions and timers, empty for none
+    privateNH.param("trace_file", tracePath, string(""));
+
+    //TRACE (open in chrome://tracing or ui.perfetto.dev)
+    //----------------------------------------------------
+    //buffers have to exist before any callback can run
+    if (!tracePath.empty())
+    {
+        if (traceLog.open(tracePath))
+        {
+            controlTrace = traceLog.createBuffer("control");
+            perceptionTrace = traceLog.createBuffer("perception");
+            poseTrace = traceLog.createBuffer("pose");
+            driveTrace = traceLog.createBuffer("drive");
+
+            core.setTimerTracing(true);
+            traceLog.start(5.0);
+        }
+        else
+        {
+            ROS_WARN("Could not open %s for the trace", tracePath.c_str());
+        }
+    }
+
+    //in lockstep the sensors are handled on the control thread with /clock,
+    //one at a time in the order they arrived, and none is dropped
+    ros::NodeHandle perceptionNH(mNH);
+    perceptionNH.setCallbackQueue(lockstep ? &controlQueue : &perceptionQueue);
+
+    ros::NodeHandle poseNH(mNH);
+    poseNH.setCallbackQueue(lockstep ? &controlQueue : &poseQueue);
+
+    uint32_t sensorQueueSize = lockstep ? lockstepBacklog : 1;
+
+    ros::NodeHandle controlNH(mNH);
+    controlNH.setCallbackQueue(&controlQueue);
+
+    joySubscriber = controlNH.subscribe((publishedName + "/joystick"), 10, &MobilityNode::joyCmdHandler, this);
+    modeSubscriber = controlNH.subscribe((publishedName + "/mode"), 1, &MobilityNode::modeHandler, this);
+    //sensor topics only ever need their newest message, anything queued behind it is older
+    targetSubscriber = perceptionNH.subscribe((publishedName + "/targets"), sensorQueueSize, &MobilityNode::targetHandler, this);
+    obstacleSubscriber = perceptionNH.subscribe((publishedName + "/obstacle"), sensorQueueSize, &MobilityNode::obstacleHandler, this);
+    odometrySubscriber = poseNH.subscribe((publishedName + "/odom/filtered"), sensorQueueSize, &MobilityNode::odometryHandler, this);
+    mapSubscriber = poseNH.subscribe((publishedName + "/odom/ekf"), sensorQueueSize, &MobilityNode::mapHandler, this);
+
+    status_publisher = mNH.advertise<std_msgs::String>((publishedName + "/status"), 1, true);
+    stateMachinePublish = mNH.advertise<std_msgs::String>((publishedName + "/state_machine"), 1, true);
+    fingerAnglePublish = mNH.advertise<std_msgs::Float32>((publishedName + "/fingerAngle/cmd"), 1, true);
+    wristAnglePublish = mNH.advertise<std_msgs::Float32>((publishedName + "/wristAngle/cmd"), 1, true);
+    infoLogPublisher = mNH.advertise<std_msgs::String>("/infoLog", 1, true);
+    driveControlPublish = mNH.advertise<geometry_msgs::Twist>((publishedName + "/driveControl"), 10);
+    mapAverageStallPublish = mNH.advertise<std_msgs::Float32>((publishedName + "/mapAverageStall"), 10);
+    diagnosticsPublish = mNH.advertise<diagnostic_msgs::DiagnosticArray>("/diagnostics", 10);
+    cyclePublish = mNH.advertise<diagnostic_msgs::DiagnosticStatus>((publishedName + "/cycle_profile"), 10, true);
+
+    publish_status_timer = controlNH.createTimer(ros::Duration(status_publish_interval), &MobilityNode::publishStatusTimerEventHandler, this);
+    if (lockstep) { clockSubscriber = controlNH.subscribe("/clock", 1000, &MobilityNode::clockHandler, this); }
+    else { stateMachineTimer = controlNH.createTimer(ros::Duration(mobilityLoopTimeStep), &MobilityNode::mobilityStateMachine, this); }
+    publish_latency_timer = controlNH.createTimer(ros::Duration(latencyReportInterval), &MobilityNode::publishLatencyTimerEventHandler, this);
+
+    //watched from the pose thread, it never waits on the control thread.  On
+    //the control timer's clock, a simulator running slow or paused is not a
+    //stall (in lockstep the loop waits for the simulator, there is none).
+    if (!lockstep) { watchdogTimer = poseNH.createTimer(ros::Duration(mobilityLoopTimeStep), &MobilityNode::watchdogCheck, this); }
+
+    //DRIVE LOOP
+    //----------------------------------------------------
+    //only worth a thread if it is faster than the planning loop
+    if (driveLoopRate > 1.0 / mobilityLoopTimeStep)
+    {
+        ros::NodeHandle driveNH(mNH);
+        driveNH.setCallbackQueue(&driveQueue);
+
+        driveTimer = driveNH.createTimer(ros::Duration(1.0 / driveLoopRate), &MobilityNode::driveLoop, this);
+
+        core.setExternalGoalTracking(true);
+
+        if (realTime) { driveQueue.addCallback(ros::CallbackInterfacePtr(new RealTimeSetup(realTimeConfig, "drive"))); }
+
+        driveSpinner = new ros::AsyncSpinner(1, &driveQueue);
+        driveSpinner->start();
+    }
+
+    tfListener = new tf::TransformListener();
+
+    //the control loop only ever reads this cache, all waiting on tf happens on its own thread
+    mapToOdomCache = new TransformCache(tfListener, publishedName + "/odom", publishedName + "/map");
+    mapToOdomCache->start(10.0, 1.0);
+
+    //EVENT LOG (decode with mobility_events)
+    //----------------------------------------------------
+    controlEvents = eventLog.createRing();
+    poseEvents = eventLog.createRing(64);
+
+    if (!eventLogPath.empty() && !eventLog.open(eventLogPath))
+    {
+        ROS_WARN("Could not open %s for the event log", eventLogPath.c_str());
+    }
+
+    ros::Publisher infoLog = infoLogPublisher;
+    eventLog.setTextSink([infoLog](const string& line)
+    {
+        std_msgs::String msg;
+        msg.data = line;
+        infoLog.publish(msg);
+    }, infoLogRate, 2.0);
+
+    eventLog.start(10.0);
+
+    logEvent(EVENT_LOG_STARTED);
+
+    //INPUT RECORDING (play back with mobility_replay)
+    //----------------------------------------------------
+    if (!recordPath.empty())
+    {
+        logEvent(recorder.open(recordPath) ? EVENT_RECORDING_INPUTS : EVENT_RECORDING_FAILED);
+    }
+
+    //FLIGHT RECORDER
+    //----------------------------------------------------
+    if (flightSeconds > 0)
+    {
+        flightRecorder = new FlightRecorder(flightSeconds, 8 * 1024 * 1024, 16384);
+        flightRecorder->setDumpPrefix(flightPrefix, 30.0, 20);
+    }
+
+    //first step lets the core do its start up (start delay, gripper reset)
+    MobilityInput input;
+    step(input);
+
+    //nothing steps the core from another thread until now, the control
+    //thread makes itself real time as soon as it starts spinning
+    if (realTime) { controlQueue.addCallback(ros::CallbackInterfacePtr(new RealTimeSetup(realTimeConfig, "control"))); }
+
+    perceptionSpinner = new ros::AsyncSpinner(1, &perceptionQueue);
+    poseSpinner = new ros::AsyncSpinner(1, &poseQueue);
+    controlSpinner = new ros::AsyncSpinner(1, &controlQueue);
+
+    perceptionSpinner->start();
+    poseSpinner->start();
+    controlSpinner->start();
+}
+
+MobilityNode::~MobilityNode()
+{
+    //control first, it reads what the others write
+    ros::AsyncSpinner* spinners[] = { controlSpinner, perceptionSpinner, poseSpinner, driveSpinner };
+
+    for (int i = 0; i < 4; i++)
+    {
+        if (spinners[i])
+        {
+            spinners[i]->stop();
+            delete spinners[i];
+        }
+    }
+
+    mapToOdomCache->stop();
+
+    delete mapToOdomCache;
+    delete tfListener;
+
+    recorder.close();
+    delete flightRecorder;
+    eventLog.stop();
+    traceLog.stop();
+    delete controlWatchdog;
+
+    writeLatencyCsv();
+}
+
+void MobilityNode::step(MobilityInput& input)
+{
+    takeSnapshots(input);
+
+    input.time = clock->seconds();
+
+    recorder.record(input);
+    if (flightRecorder) { flightRecorder->recordInput(input); }
+
+    TraceSpan span(traceLog, controlTrace, "step", "core");
+
+    const MobilityOutput& output = core.step(input);
+    publish(output);
+
+    if (flightRecorder) { recordFlight(output, input.time); }
+
+    if (flightRecorder || controlTrace)
+    {
+        recordTransitions("mobility", core.getMobilityMachine(), mobilityTransitionsSeen, span.getStart());
+        recordTransitions("reverse", core.getReverseMachine(), reverseTransitionsSeen, span.getStart());
+    }
+
+    if (controlTrace)
+    {
+        for (unsigned int i = 0; i < output.timerMarks.size(); i++)
+        {
+            const TimerMark& mark = output.timerMarks[i];
+            controlTrace->instant(mark.timer, "timer", span.getStart(), timerActionNames[mark.action]);
+        }
+    }
+
+    int mode = core.getCurrentMode();
+    int state = core.getStateMachineState();
+
+    if ((mode == 2 || mode == 3) && state >= 0 && state < LATENCY_STATES)
+    {
+        latencyState = state;
+
+        // how old the newest sensor data behind these commands was
+        if (!output.drive.empty() || !output.fingerAngles.empty() || !output.wristAngles.empty())
+        {
+            double now = clock->seconds();
+
+            for (int source = 0; source < LATENCY_SOURCES; source++)
+            {
+                recordLatency(state, source, sourceStamp[source], now);
+            }
+        }
+    }
+    else
+    {
+        latencyState = -1;
+    }
+}
+
+void MobilityNode::takeSnapshots(MobilityInput& input)
+{
+    unsigned int version = odometrySnapshot.version();
+    if (version != odometrySeen)
+    {
+        PoseSnapshot pose = odometrySnapshot.load();
+
+        input.hasOdometry = true;
+        input.odometry.x = pose.x;
+        input.odometry.y = pose.y;
+        input.odometry.theta = pose.theta;
+        input.times[SLOT_ODOMETRY].stamp = pose.stamp;
+        input.times[SLOT_ODOMETRY].received = pose.received;
+        sourceStamp[LATENCY_ODOMETRY] = pose.stamp;
+
+        odometrySeen = version;
+    }
+
+    version = mapSnapshot.version();
+    if (version != mapSeen)
+    {
+        PoseSnapshot pose = mapSnapshot.load();
+
+        input.hasMap = true;
+        input.map.x = pose.x;
+        input.map.y = pose.y;
+        input.map.theta = pose.theta;
+        input.times[SLOT_MAP].stamp = pose.stamp;
+        input.times[SLOT_MAP].received = pose.received;
+
+        mapSeen = version;
+    }
+
+    //perception coming in while the core is busy only leaves the newest message
+    ObstacleSnapshot obstacle;
+    if (obstacleMailbox.fetch(obstacle))
+    {
+        input.hasObstacle = true;
+        input.obstacle = obstacle.obstacle;
+        input.times[SLOT_OBSTACLE].stamp = obstacle.stamp;
+        input.times[SLOT_OBSTACLE].received = obstacle.received;
+        sourceStamp[LATENCY_OBSTACLE] = obstacle.stamp;
+    }
+
+    TargetsSnapshot targets;
+    if (targetsMailbox.fetch(targets))
+    {
+        input.hasTargets = true;
+        input.targets = targets.targets;
+        input.times[SLOT_TARGETS].stamp = targets.stamp;
+        input.times[SLOT_TARGETS].received = targets.received;
+        sourceStamp[LATENCY_TARGETS] = targets.stamp;
+    }
+}
+
+void MobilityNode::recordLatency(int state, int source, double stamp, double now)
+{
+    if (stamp <= 0) { return; }
+
+    latency[state][source].record((int64_t)((now - stamp) * 1e6));
+}
+
+void MobilityNode::logEvent(EventId id, double a, double b)
+{
+    controlEvents->push(makeEvent(clock->seconds(), id, a, b));
+}
+
+void MobilityNode::recordFlight(const MobilityOutput& output, double now)
+{
+    flightRecorder->recordOutput(output, now);
+
+    for (unsigned int i = 0; i < output.events.size(); i++)
+    {
+        const Event& event = output.events[i];
+
+        if (event.id == EVENT_PICKUP_GAVE_UP) { flightDump("pickup_gave_up", now); }
+        else if (event.id == EVENT_NEST_LOST) { flightDump("nest_lost", now); }
+        else if (event.id == EVENT_OBSTACLE_WAITING && event.fields[0] >= 3) { flightDump("obstacle_rearmed", now); }
+    }
+}
+
+void MobilityNode::recordTransitions(const char* name, const HierarchicalStateMachine<MobilityCore>& machine, unsigned long& seen, double traceTime)
+{
+    unsigned long count = machine.getTransitionCount();
+    if (count == seen) { return; }
+
+    vector<TransitionRecord> trace = machine.getTrace();
+    unsigned long fresh = count - seen;
+    if (fresh > trace.size()) { fresh = trace.size(); }
+
+    for (unsigned long i = trace.size() - fresh; i < trace.size(); i++)
+    {
+        const char* from = machine.getName(trace[i].from);
+        const char* to = machine.getName(trace[i].to);
+
+        if (flightRecorder) { flightRecorder->recordTransition(trace[i].time, name, from, to); }
+        if (controlTrace) { controlTrace->instant(to, name, traceTime, from); }
+    }
+
+    seen = count;
+}
+
+void MobilityNode::flightDump(const string& reason, double now)
+{
+    if (flightRecorder->dump(reason, now))
+    {
+        logEvent(EVENT_FLIGHT_DUMP, flightRecorder->getDumpCount(), flightRecorder->getSeconds());
+    }
+}
+
+void MobilityNode::publish(const MobilityOutput& output)
+{
+    for (unsigned int i = 0; i < output.events.size(); i++)
+    {
+        controlEvents->push(output.events[i]);
+    }
+
+    for (unsigned int i = 0; i < output.fingerAngles.size(); i++)
+    {
+        std_msgs::Float32 angle;
+        angle.data = output.fingerAngles[i];
+        fingerAnglePublish.publish(angle);
+    }
+
+    for (unsigned int i = 0; i < output.wristAngles.size(); i++)
+    {
+        std_msgs::Float32 angle;
+        angle.data = output.wristAngles[i];
+        wristAnglePublish.publish(angle);
+    }
+
+    for (unsigned int i = 0; i < output.drive.size(); i++)
+    {
+        geometry_msgs::Twist velocity;
+        velocity.linear.x = output.drive[i].linear;
+        velocity.angular.z = output.drive[i].angular;
+        driveControlPublish.publish(velocity);
+    }
+
+    // publish state machine string for user, only if it has changed, though
+    if (output.hasStateName && output.stateName != prevStateMachine)
+    {
+        std_msgs::String msg;
+        msg.data = output.stateName;
+        stateMachinePublish.publish(msg);
+        prevStateMachine = output.stateName;
+    }
+
+    if (output.hasTrackGoal) { goalMailbox.post(output.trackGoal); }
+
+    if (output.hasCycle) { publishCycle(output.cycle); }
+}
+
+/*************************
+* ROS CALLBACK HANDLERS *
+*************************/
+
+void MobilityNode::mobilityStateMachine(const ros::TimerEvent& event)
+{
+    TraceSpan span(traceLog, controlTrace, "mobilityStateMachine", "callback");
+    //timed on the clock stateMachineTimer runs on, sim time runs slower than wall time
+    double tickStart = clock->seconds();
+    controlWatchdog->tickStarted(tickStart);
+
+    if (controlStalled.exchange(false)) { logEvent(EVENT_CONTROL_RESUMED); }
+
+    MobilityInput input;
+    input.tick = true;
+    step(input);
+
+    ros::WallTime mapAverageStart = ros::WallTime::now();
+
+    {
+        TraceSpan centerSpan(traceLog, controlTrace, "updateCenterLocation", "callback");
+        updateCenterLocation();
+    }
+
+    // export how long the loop was held up so latency spikes show up on a plot
+    std_msgs::Float32 stall;
+    stall.data = (ros::WallTime::now() - mapAverageStart).toSec() * 1000.0;     //milliseconds
+    mapAverageStallPublish.publish(stall);
+
+    // a tick that started a whole period late or took longer than one
+    double late = (event.current_real - event.current_expected).toSec();
+    double tickEnd = clock->seconds();
+    double took = tickEnd - tickStart;
+    controlWatchdog->tickFinished(tickEnd);
+
+    if (flightRecorder && !event.last_real.isZero() && (late > mobilityLoopTimeStep || took > mobilityLoopTimeStep))
+    {
+        flightDump("overrun", input.time);
+    }
+}
+
+// Lockstep keeps every sensor message until the /clock step that reaches its
+// stamp, oldest first; a full backlog drops its oldest
+template <typename Snapshot>
+void MobilityNode::holdBack(deque<Snapshot>& pending, const Snapshot& snapshot)
+{
+    if (pending.size() >= lockstepBacklog) { pending.pop_front(); }
+    pending.push_back(snapshot);
+}
+
+// The newest of the messages due by time into due, false if none is
+template <typename Snapshot>
+bool MobilityNode::admitDue(deque<Snapshot>& pending, double time, Snapshot& due)
+{
+    bool admitted = false;
+
+    while (!pending.empty() && pending.front().stamp <= time)
+    {
+        due = pending.front();
+        pending.pop_front();
+        admitted = true;
+    }
+
+    return admitted;
+}
+
+void MobilityNode::clockHandler(const rosgraph_msgs::Clock::ConstPtr& message)
+{
+    TraceSpan span(traceLog, controlTrace, "clockHandler", "callback");
+
+    int64_t now = message->clock.toNSec();
+    if (now < lockstepClock.nanoseconds()) { return; }
+    lockstepClock.set(now);
+
+    //sensor messages stamped up to this clock go in this step, later ones
+    //wait for theirs however the threads and sockets happened to line up
+    double time = lockstepClock.seconds();
+    PoseSnapshot pose;
+    TargetsSnapshot targets;
+    ObstacleSnapshot obstacle;
+
+    if (admitDue(lockstepOdometry, time, pose)) { odometrySnapshot.store(pose); }
+    if (admitDue(lockstepMap, time, pose)) { mapSnapshot.store(pose); }
+    if (admitDue(lockstepTargets, time, targets)) { targetsMailbox.post(targets); }
+    if (admitDue(lockstepObstacle, time, obstacle)) { obstacleMailbox.post(obstacle); }
+
+    //whatever came in since the last clock message goes in this step
+    MobilityInput input = pendingInput;
+    pendingInput = MobilityInput();
+
+    //ticks fall on whole periods of sim time however the clock messages line up
+    if (now >= nextLockstepTick)
+    {
+        input.tick = true;
+        nextLockstepTick = (now / lockstepPeriod + 1) * lockstepPeriod;
+    }
+
+    step(input);
+
+    if (input.tick) { updateCenterLocation(); }
+}
+
+void MobilityNode::watchdogCheck(const ros::TimerEvent&)
+{
+    double now = clock->seconds();
+    if (!controlWatchdog->stalled(now)) { return; }
+
+    if (!controlStalled.exchange(true))
+    {
+        controlStops++;
+        poseEvents->push(makeEvent(clock->seconds(), EVENT_CONTROL_STALLED, now - controlWatchdog->getLastStart()));
+    }
+
+    //keep the wheels stopped until the control loop is back, the drive loop holds off too
+    geometry_msgs::Twist stop;
+    driveControlPublish.publish(stop);
+}
+
+void MobilityNode::controlWake()
+{
+    TraceSpan span(traceLog, controlTrace, "controlWake", "callback");
+
+    //cleared first so anything arriving during the step queues another one
+    controlWakePending = false;
+
+    MobilityInput input;
+    step(input);
+}
+
+void MobilityNode::targetHandler(const apriltags_ros::AprilTagDetectionArray::ConstPtr& message)
+{
+    TraceSpan span(traceLog, perceptionTrace, "targetHandler", "callback");
+
+    TargetsSnapshot snapshot;
+    snapshot.targets = message;
+
+    // detections carry the camera stamp, an empty array only has its arrival
+    snapshot.received = clock->seconds();
+    snapshot.stamp = snapshot.received;
+    if (!message->detections.empty() && !message->detections[0].pose.header.stamp.isZero())
+    {
+        snapshot.stamp = message->detections[0].pose.header.stamp.toSec();
+    }
+
+    if (lockstep) { holdBack(lockstepTargets, snapshot); return; }
+
+    targetsMailbox.post(snapshot);
+    wakeControl();
+}
+
+void MobilityNode::modeHandler(const std_msgs::UInt8::ConstPtr& message)
+{
+    TraceSpan span(traceLog, controlTrace, "modeHandler", "callback");
+
+    if (lockstep)
+    {
+        pendingInput.hasMode = true;
+        pendingInput.mode = message->data;
+        return;
+    }
+
+    MobilityInput input;
+    input.hasMode = true;
+    input.mode = message->data;
+    step(input);
+}
+
+void MobilityNode::obstacleHandler(const std_msgs::UInt8::ConstPtr& message)
+{
+    TraceSpan span(traceLog, perceptionTrace, "obstacleHandler", "callback");
+
+    ObstacleSnapshot snapshot;
+    snapshot.obstacle = message->data;
+    snapshot.received = clock->seconds();
+    snapshot.stamp = snapshot.received;                 // UInt8 has no header
+
+    if (lockstep) { holdBack(lockstepObstacle, snapshot); return; }
+
+    obstacleMailbox.post(snapshot);
+    wakeControl();
+}
+
+void MobilityNode::wakeControl()
+{
+    //one wake up is enough however many messages arrive before it runs
+    if (controlWakePending.exchange(true)) { return; }
+
+    controlQueue.addCallback(ros::CallbackInterfacePtr(new ControlWake(this)));
+}
+
+// odometry and map are picked up by the next control step, they don't wake it
+void MobilityNode::odometryHandler(const nav_msgs::Odometry::ConstPtr& message)
+{
+    TraceSpan span(traceLog, poseTrace, "odometryHandler", "callback");
+
+    geometry_msgs::Pose2D pose = poseFromOdometry(*message);
+
+    PoseSnapshot snapshot;
+    snapshot.x = pose.x;
+    snapshot.y = pose.y;
+    snapshot.theta = pose.theta;
+    snapshot.received = clock->seconds();
+    snapshot.stamp = message->header.stamp.isZero() ? snapshot.received : message->header.stamp.toSec();
+
+    if (lockstep) { holdBack(lockstepOdometry, snapshot); return; }
+
+    odometrySnapshot.store(snapshot);
+}
+
+void MobilityNode::mapHandler(const nav_msgs::Odometry::ConstPtr& message)
+{
+    TraceSpan span(traceLog, poseTrace, "mapHandler", "callback");
+
+    geometry_msgs::Pose2D pose = poseFromOdometry(*message);
+
+    PoseSnapshot snapshot;
+    snapshot.x = pose.x;
+    snapshot.y = pose.y;
+    snapshot.theta = pose.theta;
+    snapshot.received = clock->seconds();
+    snapshot.stamp = message->header.stamp.isZero() ? snapshot.received : message->header.stamp.toSec();
+
+    if (lockstep) { holdBack(lockstepMap, snapshot); return; }
+
+    mapSnapshot.store(snapshot);
+}
+
+void MobilityNode::joyCmdHandler(const sensor_msgs::Joy::ConstPtr& message)
+{
+    TraceSpan span(traceLog, controlTrace, "joyCmdHandler", "callback");
+
+    if (lockstep)
+    {
+        pendingInput.hasJoystick = true;
+        pendingInput.joyLinear = message->axes[4];
+        pendingInput.joyAngular = message->axes[3];
+        return;
+    }
+
+    MobilityInput input;
+    input.hasJoystick = true;
+    input.joyLinear = message->axes[4];
+    input.joyAngular = message->axes[3];
+    step(input);
+}
+
+void MobilityNode::driveLoop(const ros::TimerEvent&)
+{
+    TraceSpan span(traceLog, driveTrace, "driveLoop", "callback");
+
+    if (controlStalled) { return; }
+
+    TrackGoal goal;
+    if (goalMailbox.fetch(goal)) { goalTracker.setGoal(goal); }
+
+    if (odometrySnapshot.version() == 0) { return; }
+
+    PoseSnapshot snapshot = odometrySnapshot.load();
+
+    geometry_msgs::Pose2D location;
+    location.x = snapshot.x;
+    location.y = snapshot.y;
+    location.theta = snapshot.theta;
+
+    DriveCommand command;
+    if (goalTracker.update(location, command))
+    {
+        geometry_msgs::Twist velocity;
+        velocity.linear.x = command.linear;
+        velocity.angular.z = command.angular;
+        driveControlPublish.publish(velocity);
+
+        int state = latencyState;
+        if (state >= 0) { recordLatency(state, LATENCY_ODOMETRY, snapshot.stamp, clock->seconds()); }
+    }
+}
+
+void MobilityNode::publishStatusTimerEventHandler(const ros::TimerEvent&)
+{
+    TraceSpan span(traceLog, controlTrace, "publishStatus", "callback");
+
+    std_msgs::String msg;
+    msg.data = "CNMSRWG17 Online";
+    status_publisher.publish(msg);
+}
+
+void MobilityNode::publishLatencyTimerEventHandler(const ros::TimerEvent&)
+{
+    TraceSpan span(traceLog, controlTrace, "publishLatency", "callback");
+
+    diagnostic_msgs::DiagnosticArray diagnostics;
+    diagnostics.header.stamp = ros::Time::now();
+
+    for (int state = 0; state < LATENCY_STATES; state++)
+    {
+        for (int source = 0; source < LATENCY_SOURCES; source++)
+        {
+            const LatencyHistogram& histogram = latency[state][source];
+            if (histogram.count() == 0) { continue; }
+
+            diagnostic_msgs::DiagnosticStatus status;
+            status.level = diagnostic_msgs::DiagnosticStatus::OK;
+            status.name = publishedName + " mobility: " + latencySourceNames[source] + " to actuation in " + latencyStateNames[state];
+            status.hardware_id = publishedName;
+
+            stringstream ss;
+            ss << "p50 " << histogram.percentile(0.5) / 1000.0 << " ms, p99 " << histogram.percentile(0.99) / 1000.0 << " ms";
+            status.message = ss.str();
+
+            const char* keys[] = { "count", "mean_ms", "p50_ms", "p90_ms", "p99_ms", "max_ms" };
+            double values[] = { (double)histogram.count(), histogram.mean() / 1000.0, histogram.percentile(0.5) / 1000.0,
+                histogram.percentile(0.9) / 1000.0, histogram.percentile(0.99) / 1000.0, histogram.max() / 1000.0 };
+
+            for (int i = 0; i < 6; i++)
+            {
+                diagnostic_msgs::KeyValue value;
+                value.key = keys[i];
+
+                stringstream vs;
+                vs << values[i];
+                value.value = vs.str();
+
+                status.values.push_back(value);
+            }
+
+            diagnostics.status.push_back(status);
+        }
+    }
+
+    addWatchdogDiagnostics(diagnostics.status);
+    addCycleDiagnostics(diagnostics.status);
+    addInputDiagnostics(diagnostics.status);
+    addNestDiagnostics(diagnostics.status);
+
+    if (!diagnostics.status.empty()) { diagnosticsPublish.publish(diagnostics); }
+}
+
+void MobilityNode::addWatchdogDiagnostics(vector<diagnostic_msgs::DiagnosticStatus>& statuses)
+{
+    const LatencyHistogram& jitter = controlWatchdog->getJitter();
+    const LatencyHistogram& execution = controlWatchdog->getExecution();
+    if (execution.count() == 0) { return; }
+
+    double rate = controlWatchdog->takeRate(clock->seconds());
+    uint64_t overruns = controlWatchdog->getOverruns();
+    uint64_t missed = controlWatchdog->getMissedPeriods();
+    unsigned long stops = controlStops;
+
+    diagnostic_msgs::DiagnosticStatus status;
+    status.name = publishedName + " mobility: control loop";
+    status.hardware_id = publishedName;
+
+    //anything gone wrong since the last report shows up as a warning, the rover having been stopped as an error
+    status.level = diagnostic_msgs::DiagnosticStatus::OK;
+    if (overruns != reportedOverruns || missed != reportedMissed) { status.level = diagnostic_msgs::DiagnosticStatus::WARN; }
+    if (stops != reportedStops) { status.level = diagnostic_msgs::DiagnosticStatus::ERROR; }
+
+    reportedOverruns = overruns;
+    reportedMissed = missed;
+    reportedStops = stops;
+
+    stringstream ss;
+    ss << rate << " Hz (nominal " << 1.0 / controlWatchdog->getPeriod() << "), jitter p99 " << jitter.percentile(0.99) / 1000.0
+       << " ms, run p99 " << execution.percentile(0.99) / 1000.0 << " ms, " << overruns << " overruns, " << missed << " missed";
+    status.message = ss.str();
+
+    const char* keys[] = { "rate_hz", "period_ms", "jitter_p50_ms", "jitter_p99_ms", "jitter_max_ms", "run_p50_ms", "run_p99_ms",
+        "run_max_ms", "ticks", "overruns", "missed_periods", "stops" };
+    double values[] = { rate, controlWatchdog->getPeriod() * 1000.0, jitter.percentile(0.5) / 1000.0, jitter.percentile(0.99) / 1000.0,
+        jitter.max() / 1000.0, execution.percentile(0.5) / 1000.0, execution.percentile(0.99) / 1000.0, execution.max() / 1000.0,
+        (double)controlWatchdog->getTicks(), (double)overruns, (double)missed, (double)stops };
+
+    for (int i = 0; i < 12; i++)
+    {
+        diagnostic_msgs::KeyValue value;
+        value.key = keys[i];
+
+        stringstream vs;
+        vs << values[i];
+        value.value = vs.str();
+
+        status.values.push_back(value);
+    }
+
+    statuses.push_back(status);
+}
+
+void MobilityNode::publishCycle(const CycleRecord& cycle)
+{
+    cycleStats.add(cycle);
+
+    diagnostic_msgs::DiagnosticStatus status;
+    status.level = diagnostic_msgs::DiagnosticStatus::OK;
+    status.name = publishedName + " mobility: delivery cycle";
+    status.hardware_id = publishedName;
+
+    stringstream ss;
+    ss << "delivery " << cycle.number << " took " << cycle.total() << " s";
+    status.message = ss.str();
+
+    diagnostic_msgs::KeyValue value;
+
+    //time spent in each phase
+    for (int phase = 0; phase < CYCLE_PHASES; phase++)
+    {
+        stringstream vs;
+        vs << cycle.phaseSeconds[phase];
+
+        value.key = string(cyclePhaseName(phase)) + "_s";
+        value.value = vs.str();
+        status.values.push_back(value);
+    }
+
+    //and when each phase began, seconds into the cycle
+    for (int i = 0; i < cycle.segmentCount; i++)
+    {
+        stringstream vs;
+        vs << cycle.segments[i].start;
+
+        value.key = cyclePhaseName(cycle.segments[i].phase);
+        value.value = vs.str();
+        status.values.push_back(value);
+    }
+
+    cyclePublish.publish(status);
+}
+
+void MobilityNode::addCycleDiagnostics(vector<diagnostic_msgs::DiagnosticStatus>& statuses)
+{
+    if (cycleStats.count() == 0) { return; }
+
+    //one status per phase plus one for the whole cycle
+    for (int phase = 0; phase <= CYCLE_PHASES; phase++)
+    {
+        diagnostic_msgs::DiagnosticStatus status;
+        status.level = diagnostic_msgs::DiagnosticStatus::OK;
+        status.name = publishedName + " mobility: " + cyclePhaseName(phase) + " time per delivery";
+        status.hardware_id = publishedName;
+
+        stringstream ss;
+        ss << "p50 " << cycleStats.percentile(phase, 0.5) << " s, p95 " << cycleStats.percentile(phase, 0.95) << " s";
+        status.message = ss.str();
+
+        const char* keys[] = { "cycles", "mean_s", "p50_s", "p95_s" };
+        double values[] = { (double)cycleStats.count(), cycleStats.mean(phase), cycleStats.percentile(phase, 0.5),
+            cycleStats.percentile(phase, 0.95) };
+
+        for (int i = 0; i < 4; i++)
+        {
+            diagnostic_msgs::KeyValue value;
+            value.key = keys[i];
+
+            stringstream vs;
+            vs << values[i];
+            value.value = vs.str();
+
+            status.values.push_back(value);
+        }
+
+        statuses.push_back(status);
+    }
+}
+
+void MobilityNode::addInputDiagnostics(vector<diagnostic_msgs::DiagnosticStatus>& statuses)
+{
+    diagnostic_msgs::DiagnosticStatus status;
+    status.level = diagnostic_msgs::DiagnosticStatus::OK;
+    status.name = publishedName + " mobility: input freshness";
+    status.hardware_id = publishedName;
+
+    stringstream ss;
+
+    //one line per sensor: age_s, delay_s (stamp to callback) and stale
+    for (int slot = 0; slot < INPUT_SLOTS; slot++)
+    {
+        bool stale = core.isInputStale(slot);
+        if (stale)
+        {
+            status.level = diagnostic_msgs::DiagnosticStatus::WARN;
+            ss << (ss.tellp() > 0 ? ", " : "") << inputSlotNames[slot] << " stale";
+        }
+
+        const char* keys[] = { "_age_s", "_delay_s", "_stale" };
+        double values[] = { core.getInputAge(slot), core.getInputDelay(slot), stale ? 1.0 : 0.0 };
+
+        for (int i = 0; i < 3; i++)
+        {
+            diagnostic_msgs::KeyValue value;
+            value.key = string(inputSlotNames[slot]) + keys[i];
+
+            stringstream vs;
+            vs << values[i];
+            value.value = vs.str();
+
+            status.values.push_back(value);
+        }
+    }
+
+    diagnostic_msgs::KeyValue dropped;
+    dropped.key = "stale_frames_dropped";
+    dropped.value = to_string(core.getStaleFramesDropped());
+    status.values.push_back(dropped);
+
+    status.message = status.level == diagnostic_msgs::DiagnosticStatus::OK ? "all inputs fresh" : ss.str();
+
+    statuses.push_back(status);
+}
+
+void MobilityNode::addNestDiagnostics(vector<diagnostic_msgs::DiagnosticStatus>& statuses)
+{
+    const NestEstimator& nest = core.getNestEstimate();
+    if (!nest.known()) { return; }
+
+    double now = core.getTime();
+
+    diagnostic_msgs::DiagnosticStatus status;
+    status.level = diagnostic_msgs::DiagnosticStatus::OK;
+    status.name = publishedName + " mobility: nest estimate";
+    status.hardware_id = publishedName;
+
+    stringstream ss;
+    ss << "(" << nest.getX() << ", " << nest.getY() << ") +- " << nest.uncertainty(now) << " m";
+    status.message = ss.str();
+
+    const char* keys[] = { "x", "y", "variance_x", "variance_y", "covariance_xy", "uncertainty_m", "points", "rejected" };
+    double values[] = { nest.getX(), nest.getY(), nest.getVarianceX(now), nest.getVarianceY(now), nest.getCovarianceXY(),
+        nest.uncertainty(now), (double)nest.getUpdates(), (double)nest.getRejected() };
+
+    for (int i = 0; i < 8; i++)
+    {
+        diagnostic_msgs::KeyValue value;
+        value.key = keys[i];
+
+        stringstream vs;
+        vs << values[i];
+        value.value = vs.str();
+
+        status.values.push_back(value);
+    }
+
+    statuses.push_back(status);
+}
+
+void MobilityNode::writeLatencyCsv()
+{
+    if (latencyCsvPath.empty()) { return; }
+
+    ofstream csv(latencyCsvPath.c_str());
+    if (!csv) { return; }
+
+    csv << "state,source,count,min_ms,mean_ms,p50_ms,p90_ms,p99_ms,p999_ms,max_ms" << endl;
+
+    for (int state = 0; state < LATENCY_STATES; state++)
+    {
+        for (int source = 0; source < LATENCY_SOURCES; source++)
+        {
+            const LatencyHistogram& histogram = latency[state][source];
+
+            csv << latencyStateNames[state] << "," << latencySourceNames[source] << ","
+                << histogram.count() << "," << histogram.min() / 1000.0 << "," << histogram.mean() / 1000.0 << ","
+                << histogram.percentile(0.5) / 1000.0 << "," << histogram.percentile(0.9) / 1000.0 << ","
+                << histogram.percentile(0.99) / 1000.0 << "," << histogram.percentile(0.999) / 1000.0 << ","
+                << histogram.max() / 1000.0 << endl;
+        }
+    }
+}
+
+void MobilityNode::updateCenterLocation()
+{
+    // only run below code if a centerLocation has been set by initilization
+    if (!core.isInitialized()) { return; }
+
+    // center location in map frame
+    geometry_msgs::Pose2D mapPose = core.getCenterLocationMap();
+    geometry_msgs::Pose2D odomPose;
+
+    //uses whatever transform the background thread last got from tf, never waits on it
+    if (mapToOdomCache->transform(mapPose, odomPose, mapToOdomMaxAge))
+    {
+        // Use the position provided by the cached transform.
+        centerLocation.x = odomPose.x; //set centerLocation in odom frame
+        centerLocation.y = odomPose.y;
+        centerLocationValid = true;
+        reportedStale = false;
+    }
+    else if (!reportedStale)
+    {
+        //no usable transform, keep the last good centerLocation instead of garbage
+        logEvent(EVENT_TRANSFORM_STALE, mapToOdomCache->getAge());
+        reportedStale = true;
+    }
+}
+
+geometry_msgs::Pose2D poseFromOdometry(const nav_msgs::Odometry& message)
+{
+    geometry_msgs::Pose2D pose;
+
+    //Get (x,y) location directly from pose
+    pose.x = message.pose.pose.position.x;
+    pose.y = message.pose.pose.position.y;
+
+    //Get theta rotation by converting quaternion orientation to pitch/roll/yaw
+    tf::Quaternion q(message.pose.pose.orientation.x, message.pose.pose.orientation.y, message.pose.pose.orientation.z, message.pose.pose.orientation.w);
+    tf::Matrix3x3 m(q);
+    double roll, pitch, yaw;
+    m.getRPY(roll, pitch, yaw);
+    pose.theta = yaw;
+
+    return pose;
+}
@@ -0,0 +1,246 @@
+#ifndef MOBILITYNODE_H
+#define MOBILITYNODE_H
+
+#include <atomic>
+#include <deque>
+#include <string>
+
+#include <ros/ros.h>
+#include <ros/callback_queue.h>
+#include <tf/transform_listener.h>
+
+// ROS messages
+#include <std_msgs/UInt8.h>
+#include <sensor_msgs/Joy.h>
+#include <nav_msgs/Odometry.h>
+#include <apriltags_ros/AprilTagDetectionArray.h>
+#include <rosgraph_msgs/Clock.h>
+#include <diagnostic_msgs/DiagnosticStatus.h>
+
+#include "MobilityCore.h"
+#include "TransformCache.h"
+#include "GoalTracker.h"
+#include "Mailbox.h"
+#include "SeqLock.h"
+#include "InputLog.h"
+#include "EventLog.h"
+#include "FlightRecorder.h"
+#include "LatencyHistogram.h"
+#include "TraceLog.h"
+#include "LoopWatchdog.h"
+#include "mobility/RealTime.h"
+#include "RosClock.h"
+
+/**
+ * The ROS side of mobility.  Turns messages and timer ticks into
+ * MobilityInputs, steps the MobilityCore on the control thread and publishes
+ * whatever it asked for; no rover behaviour lives in here.  Sensor
+ * callbacks only store snapshots for the control thread to pick up, the
+ * ~parameters are described where the constructor reads them.
+ */
+class MobilityNode
+{
+public:
+  // Topics are relative to nh, ~parameters are read from privateNH.
+  // lockMemory false leaves ~realtime to the threads, for a process the
+  // node shares (a nodelet manager)
+  MobilityNode(ros::NodeHandle& nh, ros::NodeHandle& privateNH, std::string publishedName, bool lockMemory);
+  ~MobilityNode();
+
+private:
+  class ControlWake;
+  class RealTimeSetup;
+
+  //Snapshots handed from the perception and pose threads to the control thread
+  struct PoseSnapshot {
+    double x, y, theta;
+    double stamp;                               // ros time of the message
+    double received;                            // ros time its callback ran
+  };
+
+  struct TargetsSnapshot {
+    apriltags_ros::AprilTagDetectionArray::ConstPtr targets;
+    double stamp;
+    double received;
+  };
+
+  struct ObstacleSnapshot {
+    int obstacle;
+    double stamp;
+    double received;
+  };
+
+  //Perception thread (perceptionQueue, controlQueue in lockstep)
+  void targetHandler(const apriltags_ros::AprilTagDetectionArray::ConstPtr& tagInfo);
+  void obstacleHandler(const std_msgs::UInt8::ConstPtr& message);
+  void wakeControl();
+
+  //Pose thread (poseQueue, controlQueue in lockstep)
+  void odometryHandler(const nav_msgs::Odometry::ConstPtr& message);
+  void mapHandler(const nav_msgs::Odometry::ConstPtr& message);
+
+  //Control thread (controlQueue)
+  void joyCmdHandler(const sensor_msgs::Joy::ConstPtr& message);
+  void modeHandler(const std_msgs::UInt8::ConstPtr& message);
+  void mobilityStateMachine(const ros::TimerEvent&);
+  void controlWake();
+  void clockHandler(const rosgraph_msgs::Clock::ConstPtr& message);      // lockstep only
+  template <typename Snapshot> void holdBack(std::deque<Snapshot>& pending, const Snapshot& snapshot);
+  template <typename Snapshot> bool admitDue(std::deque<Snapshot>& pending, double time, Snapshot& due);
+  void watchdogCheck(const ros::TimerEvent& event);         // pose thread
+  void publishStatusTimerEventHandler(const ros::TimerEvent& event);
+
+  //Drive loop (driveQueue thread only)
+  void driveLoop(const ros::TimerEvent&);
+
+  //Latency instrumentation
+  void recordLatency(int state, int source, double stamp, double now);
+  void publishLatencyTimerEventHandler(const ros::TimerEvent& event);
+  void writeLatencyCsv();
+
+  //Control loop watchdog
+  void addWatchdogDiagnostics(std::vector<diagnostic_msgs::DiagnosticStatus>& statuses);
+
+  //Cycle profiling
+  void publishCycle(const CycleRecord& cycle);
+  void addCycleDiagnostics(std::vector<diagnostic_msgs::DiagnosticStatus>& statuses);
+  void addInputDiagnostics(std::vector<diagnostic_msgs::DiagnosticStatus>& statuses);
+  void addNestDiagnostics(std::vector<diagnostic_msgs::DiagnosticStatus>& statuses);
+
+  // Adds whatever snapshots changed to input, runs the core on it and
+  // publishes what comes out.  Control thread only.
+  void step(MobilityInput& input);
+  void takeSnapshots(MobilityInput& input);
+  void publish(const MobilityOutput& output);
+
+  // Logs an event of the node's own, control thread only
+  void logEvent(EventId id, double a = 0, double b = 0);
+
+  // Feeds the flight recorder what the step did and dumps it on an anomaly,
+  // recordTransitions also hands the state changes to the trace
+  void recordFlight(const MobilityOutput& output, double now);
+  void recordTransitions(const char* name, const HierarchicalStateMachine<MobilityCore>& machine, unsigned long& seen, double traceTime);
+  void flightDump(const std::string& reason, double now);
+
+  // Center of the nest transformed from map into odom frame using the cached transform
+  void updateCenterLocation();
+
+  std::string publishedName;
+  const Clock* clock;                           // every (sim aware) time the node hands on or times the loops with
+  RosClock rosClock;
+  StepClock lockstepClock;                      // the last /clock message, in lockstep
+  MobilityCore core;
+  InputRecorder recorder;                       // every input handed to core, if ~record_inputs is set
+  EventLog eventLog;
+  EventRing* controlEvents;                     // control thread's ring in eventLog
+  EventRing* poseEvents;                        // pose thread's (the watchdog)
+  FlightRecorder* flightRecorder;               // NULL if ~flight_recorder_seconds is 0
+  TraceLog traceLog;
+  TraceBuffer* controlTrace;                    // one per thread, all NULL unless ~trace_file is set
+  TraceBuffer* perceptionTrace;
+  TraceBuffer* poseTrace;
+  TraceBuffer* driveTrace;
+  unsigned long mobilityTransitionsSeen;
+  unsigned long reverseTransitionsSeen;
+
+  float mobilityLoopTimeStep;                   // time between the mobility loop calls
+  double driveLoopRate;                         // Hz, 0 leaves the driving to the planning loop
+  float status_publish_interval;
+  std::string prevStateMachine;
+
+  // Callback queues and the threads spinning them, ahead of the subscribers
+  // and timers registered on them so they are destroyed after those
+  ros::CallbackQueue perceptionQueue;
+  ros::CallbackQueue poseQueue;
+  ros::CallbackQueue controlQueue;
+  ros::AsyncSpinner* perceptionSpinner;
+  ros::AsyncSpinner* poseSpinner;
+  ros::AsyncSpinner* controlSpinner;
+
+  // Publishers
+  ros::Publisher stateMachinePublish;
+  ros::Publisher status_publisher;
+  ros::Publisher fingerAnglePublish;
+  ros::Publisher wristAnglePublish;
+  ros::Publisher infoLogPublisher;
+  ros::Publisher driveControlPublish;
+  ros::Publisher mapAverageStallPublish;
+  ros::Publisher diagnosticsPublish;
+  ros::Publisher cyclePublish;
+
+  // Subscribers
+  ros::Subscriber joySubscriber;
+  ros::Subscriber modeSubscriber;
+  ros::Subscriber targetSubscriber;
+  ros::Subscriber obstacleSubscriber;
+  ros::Subscriber odometrySubscriber;
+  ros::Subscriber mapSubscriber;
+  ros::Subscriber clockSubscriber;
+
+  // Timers
+  ros::Timer stateMachineTimer;
+  ros::Timer publish_status_timer;
+  ros::Timer publish_latency_timer;
+  ros::Timer watchdogTimer;
+
+  // Snapshots (written on the perception/pose threads, read on the control and drive threads)
+  SeqLock<PoseSnapshot> odometrySnapshot;
+  SeqLock<PoseSnapshot> mapSnapshot;
+  Mailbox<TargetsSnapshot> targetsMailbox;
+  Mailbox<ObstacleSnapshot> obstacleMailbox;
+  unsigned int odometrySeen;                    // snapshot versions the control thread already stepped
+  unsigned int mapSeen;
+  std::atomic<bool> controlWakePending;         // a ControlWake is queued on controlQueue
+
+  // Drive loop
+  ros::CallbackQueue driveQueue;
+  ros::AsyncSpinner* driveSpinner;
+  ros::Timer driveTimer;
+  Mailbox<TrackGoal> goalMailbox;               // planning loop -> drive loop
+  GoalTracker goalTracker;
+
+  // Sensor -> actuation latency
+  enum LatencySource { LATENCY_ODOMETRY, LATENCY_TARGETS, LATENCY_OBSTACLE, LATENCY_SOURCES };
+  static const int LATENCY_STATES = STATE_MACHINE_DROPOFF + 1;
+
+  LatencyHistogram latency[LATENCY_STATES][LATENCY_SOURCES];
+  double sourceStamp[LATENCY_SOURCES];          // ros time of the newest message of each kind fed to the core, 0 if none yet (control thread)
+  std::atomic<int> latencyState;                // state after the last planning step, -1 when not autonomous
+  float latencyReportInterval;
+  std::string latencyCsvPath;
+
+  // Lockstep (control thread)
+  bool lockstep;
+  int64_t lockstepPeriod;                       // nanoseconds of sim time between ticks
+  int64_t nextLockstepTick;
+  MobilityInput pendingInput;                   // mode/joystick waiting for the next /clock step
+  std::deque<PoseSnapshot> lockstepOdometry;    // sensor messages stamped past the clock, in arrival order
+  std::deque<PoseSnapshot> lockstepMap;
+  std::deque<TargetsSnapshot> lockstepTargets;
+  std::deque<ObstacleSnapshot> lockstepObstacle;
+
+  // Control loop watchdog
+  LoopWatchdog* controlWatchdog;                // ticks timed on the control thread, checked on the pose thread
+  std::atomic<bool> controlStalled;             // the watchdog has stopped the rover
+  std::atomic<unsigned long> controlStops;
+  uint64_t reportedOverruns;                    // as of the last diagnostics report
+  uint64_t reportedMissed;
+  unsigned long reportedStops;
+
+  // Delivery cycle phases (control thread)
+  static const unsigned int cycleWindow = 20;
+  CycleStats cycleStats;                        // the last cycleWindow deliveries
+
+  //Transforms
+  tf::TransformListener* tfListener;
+  TransformCache* mapToOdomCache;               // map -> odom kept up to date off the control loop
+  double mapToOdomMaxAge;                       // seconds before a cached transform is considered stale
+  geometry_msgs::Pose2D centerLocation;         // location of the center in odom frame
+  bool centerLocationValid;                     // centerLocation has been transformed at least once
+  bool reportedStale;
+};
+
+// Converts an odometry message to the 2D pose the core works with
+geometry_msgs::Pose2D poseFromOdometry(const nav_msgs::Odometry& message);
+
+#endif // MOBILITYNODE_H
@@ -0,0 +1,64 @@
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <unistd.h>
+
+#include "MobilityNode.h"
+
+using namespace std;
+
+namespace mobility
+{
+
+/**
+ * MobilityNode loaded into a nodelet manager.  Loaded into the same manager
+ * as the camera/AprilTag and obstacle nodelets, /targets and /obstacle are
+ * handed over as shared pointers instead of being serialized over TCPROS.
+ *
+ * The rover name is the first nodelet argument, like the mobility
+ * executable's, and defaults to the hostname.  MobilityNode keeps its own
+ * callback queues and threads, the manager's are only used to load it.
+ *
+ * ~realtime only raises those threads here.  The memory is not locked: that
+ * would lock the whole manager, camera and AprilTag image buffers included.
+ */
+class MobilityNodelet : public nodelet::Nodelet
+{
+public:
+    MobilityNodelet() : node(NULL) {}
+    ~MobilityNodelet() { delete node; }
+
+private:
+    virtual void onInit()
+    {
+        string publishedName;
+
+        const nodelet::V_string& argv = getMyArgv();
+        if (!argv.empty())
+        {
+            publishedName = argv[0];
+        }
+        else
+        {
+            char host[128];
+            gethostname(host, sizeof(host));
+            publishedName = host;
+        }
+
+        bool realTime;
+        getPrivateNodeHandle().param("realtime", realTime, false);
+        if (realTime)
+        {
+            NODELET_WARN("~realtime does not lock memory in the mobility nodelet, run the mobility executable for it");
+        }
+
+        NODELET_INFO("Mobility nodelet started for %s", publishedName.c_str());
+
+        node = new MobilityNode(getNodeHandle(), getPrivateNodeHandle(), publishedName, false);
+    }
+
+    MobilityNode* node;
+};
+
+}
+
+PLUGINLIB_EXPORT_CLASS(mobility::MobilityNodelet, nodelet::Nodelet)
@@ -0,0 +1,164 @@
+#include "NestEstimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+NestEstimator::NestEstimator()
+{
+    driftSd = 0;
+    gateSigmas = 0;
+    gateDistance = 0;
+    restartAfter = 0;
+
+    clear();
+}
+
+void NestEstimator::setGate(double gateSigmas, double gateDistance, int restartAfter)
+{
+    this->gateSigmas = gateSigmas;
+    this->gateDistance = gateDistance;
+    this->restartAfter = restartAfter;
+}
+
+void NestEstimator::clear()
+{
+    x = 0;
+    y = 0;
+    varianceXX = 0;
+    varianceXY = 0;
+    varianceYY = 0;
+    lastTime = 0;
+
+    updates = 0;
+    rejected = 0;
+    rejectedInARow = 0;
+}
+
+double NestEstimator::drift(double now) const
+{
+    return now > lastTime ? driftSd * driftSd * (now - lastTime) : 0;
+}
+
+void NestEstimator::predict(double now)
+{
+    double grown = drift(now);
+    varianceXX += grown;
+    varianceYY += grown;
+
+    lastTime = max(lastTime, now);
+}
+
+void NestEstimator::restart(double x, double y, double sd, double now)
+{
+    this->x = x;
+    this->y = y;
+    varianceXX = sd * sd;
+    varianceXY = 0;
+    varianceYY = sd * sd;
+    lastTime = now;
+
+    rejectedInARow = 0;
+}
+
+NestEstimator::UpdateResult NestEstimator::update(double x, double y, double sd, double now)
+{
+    if (!known())
+    {
+        restart(x, y, sd, now);
+        updates++;
+        return NEST_ACCEPTED;
+    }
+
+    predict(now);
+
+    if (gateSigmas > 0 && hypot(x - this->x, y - this->y) > gateDistance && sigmasFrom(x, y, sd, now) > gateSigmas)
+    {
+        rejected++;
+        rejectedInARow++;
+
+        if (restartAfter <= 0 || rejectedInARow < restartAfter) { return NEST_REJECTED; }
+
+        restart(x, y, sd, now);
+        updates++;
+        return NEST_RESTARTED;
+    }
+
+    //innovation covariance S = P + R, gain K = P S^-1
+    double r = sd * sd;
+    double sXX = varianceXX + r;
+    double sXY = varianceXY;
+    double sYY = varianceYY + r;
+    double det = sXX * sYY - sXY * sXY;
+
+    double inverseXX = sYY / det;
+    double inverseXY = -sXY / det;
+    double inverseYY = sXX / det;
+
+    double gainXX = varianceXX * inverseXX + varianceXY * inverseXY;
+    double gainXY = varianceXX * inverseXY + varianceXY * inverseYY;
+    double gainYX = varianceXY * inverseXX + varianceYY * inverseXY;
+    double gainYY = varianceXY * inverseXY + varianceYY * inverseYY;
+
+    double dx = x - this->x;
+    double dy = y - this->y;
+    this->x += gainXX * dx + gainXY * dy;
+    this->y += gainYX * dx + gainYY * dy;
+
+    //P = (I - K) P
+    double newXX = (1 - gainXX) * varianceXX - gainXY * varianceXY;
+    double newXY = (1 - gainXX) * varianceXY - gainXY * varianceYY;
+    double newYY = -gainYX * varianceXY + (1 - gainYY) * varianceYY;
+
+    varianceXX = newXX;
+    varianceXY = newXY;
+    varianceYY = newYY;
+
+    updates++;
+    rejectedInARow = 0;
+
+    return NEST_ACCEPTED;
+}
+
+void NestEstimator::inflate(double sd)
+{
+    varianceXX += sd * sd;
+    varianceYY += sd * sd;
+}
+
+geometry_msgs::Pose2D NestEstimator::getLocation() const
+{
+    geometry_msgs::Pose2D location;
+    location.x = x;
+    location.y = y;
+    location.theta = 0;
+
+    return location;
+}
+
+double NestEstimator::uncertainty(double now) const
+{
+    double xx = getVarianceX(now);
+    double yy = getVarianceY(now);
+
+    //largest eigenvalue of the covariance
+    double half = (xx + yy) / 2;
+    double largest = half + sqrt(max(0.0, (xx - yy) * (xx - yy) / 4 + varianceXY * varianceXY));
+
+    return sqrt(largest);
+}
+
+double NestEstimator::sigmasFrom(double x, double y, double sd, double now) const
+{
+    double xx = getVarianceX(now) + sd * sd;
+    double yy = getVarianceY(now) + sd * sd;
+    double det = xx * yy - varianceXY * varianceXY;
+
+    double dx = x - this->x;
+    double dy = y - this->y;
+
+    if (det <= 0) { return dx == 0 && dy == 0 ? 0 : HUGE_VAL; }
+
+    return sqrt((yy * dx * dx - 2 * varianceXY * dx * dy + xx * dy * dy) / det);
+}
@@ -0,0 +1,81 @@
+#ifndef NESTESTIMATOR_H
+#define NESTESTIMATOR_H
+
+#include <geometry_msgs/Pose2D.h>
+
+/**
+ * Where the nest is in the map frame, as a Kalman filter on its position.
+ *
+ * Every derived center point comes with the standard deviation its source
+ * deserves (a first glance, a GPS averaged squaring up, the spot a block
+ * was dropped at), and the estimate moves towards it by that much.  The map
+ * drifts, so the covariance grows with time between points.
+ *
+ * A point further than gateSigmas (counting the point's own sd as well as
+ * the estimate's) and at least gateDistance meters from the estimate is
+ * refused.  After restartAfter refusals in a row the estimate is the one
+ * that is wrong, it starts over from the last point.  Losing the nest
+ * doesn't throw the estimate away, inflate() only makes it less sure so
+ * the next sighting counts for more.
+ */
+class NestEstimator
+{
+public:
+    NestEstimator();
+
+    // driftSd: map drift, meters per square root second
+    void setDrift(double driftSd) { this->driftSd = driftSd; }
+    void setGate(double gateSigmas, double gateDistance, int restartAfter);
+
+    enum UpdateResult { NEST_ACCEPTED, NEST_REJECTED, NEST_RESTARTED };
+
+    // A center point with its standard deviation, in meters
+    UpdateResult update(double x, double y, double sd, double now);
+
+    // Adds sd^2 to the variance of both axes
+    void inflate(double sd);
+
+    void clear();
+
+    bool known() const { return updates > 0; }
+    geometry_msgs::Pose2D getLocation() const;
+
+    double getX() const { return x; }
+    double getY() const { return y; }
+    double getVarianceX(double now) const { return varianceXX + drift(now); }
+    double getVarianceY(double now) const { return varianceYY + drift(now); }
+    double getCovarianceXY() const { return varianceXY; }
+
+    // Standard deviation along the worst direction, meters
+    double uncertainty(double now) const;
+
+    // Mahalanobis distance of a point with standard deviation sd from the
+    // estimate, in standard deviations of their difference (P + R)
+    double sigmasFrom(double x, double y, double sd, double now) const;
+
+    unsigned int getUpdates() const { return updates; }
+    unsigned int getRejected() const { return rejected; }
+
+private:
+    double drift(double now) const;
+    void predict(double now);
+    void restart(double x, double y, double sd, double now);
+
+    double x;
+    double y;
+    double varianceXX;
+    double varianceXY;
+    double varianceYY;
+    double lastTime;                        // time the covariance was grown to
+
+    double driftSd;
+    double gateSigmas;
+    double gateDistance;
+    int restartAfter;
+
+    unsigned int updates;
+    unsigned int rejected;
+    int rejectedInARow;
+};
+
+#endif // NESTESTIMATOR_H
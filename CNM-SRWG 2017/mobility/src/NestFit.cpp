@@ -0,0 +1,221 @@
+#include "NestFit.h"
+
+#include <cmath>
+
+using namespace std;
+
+const int MIN_TAGS = 3;                                     //fewer than this and any square fits
+const int ITERATIONS = 10;
+const double DAMPING = 1e-3;                                //keeps a single edge (center free along it) solvable
+const double CONVERGED = 1e-4;                              //meters/radians of step to stop at
+const double MAX_RESIDUAL = 0.1;                            //rms meters, past this it isn't the nest's edges
+const double EDGE_TOLERANCE = 0.15;                         //meters from an edge for a tag to count as on it
+
+//confidence is tags/(tags + TAGS_SCALE) style saturation, times the residual's fall off
+const double TAGS_SCALE = 4;
+const double RESIDUAL_SCALE = 0.06;
+const double SINGLE_EDGE_WEIGHT = 0.8;                      //one edge only places the center across it
+
+NestFit::NestFit()
+{
+    valid = false;
+    x = 0;
+    y = 0;
+    theta = 0;
+    residual = 0;
+    tags = 0;
+    edges = 0;
+    confidence = 0;
+}
+
+//residual of every tag to its nearest edge and its derivative by (x, y, theta)
+static double edgeResidual(double tagX, double tagY, double x, double y, double c, double s, double jacobian[3], int& edge)
+{
+    double dx = tagX - x;
+    double dy = tagY - y;
+    double u = c * dx + s * dy;             //along the theta edges' normal
+    double v = -s * dx + c * dy;
+
+    if (fabs(u) >= fabs(v))
+    {
+        double sign = u < 0 ? -1 : 1;
+        jacobian[0] = -sign * c;
+        jacobian[1] = -sign * s;
+        jacobian[2] = sign * v;
+        edge = u < 0 ? 2 : 0;
+        return fabs(u) - NEST_SIDE / 2;
+    }
+
+    double sign = v < 0 ? -1 : 1;
+    jacobian[0] = sign * s;
+    jacobian[1] = -sign * c;
+    jacobian[2] = -sign * u;
+    edge = v < 0 ? 3 : 1;
+    return fabs(v) - NEST_SIDE / 2;
+}
+
+bool NestFit::fit(const PerceptionFrame& frame)
+{
+    valid = false;
+    tags = 0;
+    edges = 0;
+    confidence = 0;
+
+    if (!frame.projected) { return false; }
+
+    for (int k = 0; k < frame.nestKept; k++)
+    {
+        int tag = frame.nest[k];
+        tagX[tags] = frame.mapX[tag];
+        tagY[tags] = frame.mapY[tag];
+        tags++;
+    }
+
+    if (tags < MIN_TAGS) { return false; }
+
+    //centroid and principal axis of the tags
+    double meanX = 0, meanY = 0;
+    for (int i = 0; i < tags; i++)
+    {
+        meanX += tagX[i];
+        meanY += tagY[i];
+    }
+    meanX /= tags;
+    meanY /= tags;
+
+    double sxx = 0, syy = 0, sxy = 0;
+    for (int i = 0; i < tags; i++)
+    {
+        double dx = tagX[i] - meanX;
+        double dy = tagY[i] - meanY;
+        sxx += dx * dx;
+        syy += dy * dy;
+        sxy += dx * dy;
+    }
+
+    double axis = 0.5 * atan2(2 * sxy, sxx - syy);
+
+    //the nest is on the far side of the tags from the rover
+    double normalX = -sin(axis);
+    double normalY = cos(axis);
+    if ((meanX - frame.map.x) * normalX + (meanY - frame.map.y) * normalY < 0)
+    {
+        normalX = -normalX;
+        normalY = -normalY;
+    }
+
+    //one edge in view lines up with the axis, a corner sits across it;
+    //start from both and keep the better fit
+    const double starts[2] = { axis, axis + M_PI / 4 };
+    double bestSquares = -1;
+
+    for (int start = 0; start < 2; start++)
+    {
+        double fitX = meanX + normalX * NEST_SIDE / 2;
+        double fitY = meanY + normalY * NEST_SIDE / 2;
+        double fitTheta = starts[start];
+
+        for (int iteration = 0; iteration < ITERATIONS; iteration++)
+        {
+            double normal[3][3] = {{0}};
+            double gradient[3] = {0};
+            double c = cos(fitTheta);
+            double s = sin(fitTheta);
+
+            for (int i = 0; i < tags; i++)
+            {
+                double jacobian[3];
+                int edge;
+                double r = edgeResidual(tagX[i], tagY[i], fitX, fitY, c, s, jacobian, edge);
+
+                for (int row = 0; row < 3; row++)
+                {
+                    gradient[row] -= jacobian[row] * r;
+                    for (int col = 0; col < 3; col++) { normal[row][col] += jacobian[row] * jacobian[col]; }
+                }
+            }
+
+            for (int k = 0; k < 3; k++) { normal[k][k] += DAMPING * tags; }
+
+            double step[3];
+            if (!solve(normal, gradient, step)) { break; }
+
+            fitX += step[0];
+            fitY += step[1];
+            fitTheta += step[2];
+
+            if (fabs(step[0]) + fabs(step[1]) + fabs(step[2]) < CONVERGED) { break; }
+        }
+
+        double squares = 0;
+        double c = cos(fitTheta);
+        double s = sin(fitTheta);
+        for (int i = 0; i < tags; i++)
+        {
+            double jacobian[3];
+            int edge;
+            double r = edgeResidual(tagX[i], tagY[i], fitX, fitY, c, s, jacobian, edge);
+            squares += r * r;
+        }
+
+        if (bestSquares < 0 || squares < bestSquares)
+        {
+            bestSquares = squares;
+            x = fitX;
+            y = fitY;
+            theta = fitTheta;
+        }
+    }
+
+    //a square looks the same every quarter turn
+    theta -= (M_PI / 2) * floor((theta + M_PI / 4) / (M_PI / 2));
+    residual = sqrt(bestSquares / tags);
+
+    int onEdge[4] = {0};
+    double c = cos(theta);
+    double s = sin(theta);
+    for (int i = 0; i < tags; i++)
+    {
+        double jacobian[3];
+        int edge;
+        double r = edgeResidual(tagX[i], tagY[i], x, y, c, s, jacobian, edge);
+        if (fabs(r) < EDGE_TOLERANCE) { onEdge[edge]++; }
+    }
+    for (int edge = 0; edge < 4; edge++)
+    {
+        if (onEdge[edge] >= 2) { edges++; }
+    }
+
+    if (residual > MAX_RESIDUAL || edges == 0) { return false; }
+
+    confidence = (tags / (tags + TAGS_SCALE)) * exp(-(residual / RESIDUAL_SCALE) * (residual / RESIDUAL_SCALE));
+    if (edges < 2) { confidence *= SINGLE_EDGE_WEIGHT; }
+
+    valid = true;
+    return true;
+}
+
+//normal * step = gradient by Cramer's rule, false if normal is singular
+bool NestFit::solve(double normal[3][3], double gradient[3], double step[3])
+{
+    double det = normal[0][0] * (normal[1][1] * normal[2][2] - normal[1][2] * normal[2][1])
+               - normal[0][1] * (normal[1][0] * normal[2][2] - normal[1][2] * normal[2][0])
+               + normal[0][2] * (normal[1][0] * normal[2][1] - normal[1][1] * normal[2][0]);
+
+    if (fabs(det) < 1e-12) { return false; }
+
+    for (int k = 0; k < 3; k++)
+    {
+        double m[3][3];
+        for (int row = 0; row < 3; row++)
+        {
+            for (int col = 0; col < 3; col++) { m[row][col] = col == k ? gradient[row] : normal[row][col]; }
+        }
+
+        step[k] = (m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+                 - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+                 + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0])) / det;
+    }
+
+    return true;
+}
@@ -0,0 +1,50 @@
+#ifndef NESTFIT_H
+#define NESTFIT_H
+
+#include <geometry_msgs/Pose2D.h>
+
+#include "PerceptionFrame.h"
+
+/**
+ * Places the nest from one camera frame: the nest tags (id 256) line the
+ * edges of a NEST_SIDE square, so their ground positions in the map frame
+ * are fitted with that square by least squares (Gauss-Newton on center and
+ * edge direction, every tag pulled onto its nearest edge).
+ *
+ * The fit starts from the tags' centroid pushed half a side away from the
+ * rover, along their principal axis, so it ends up on the far side of the
+ * tags the rover is looking at.  With only one edge in view the center
+ * along that edge is where the visible tags are centered; the confidence
+ * says so.
+ */
+
+static const double NEST_SIDE = 1.0;        // meters, tag line to tag line
+
+class NestFit
+{
+public:
+    NestFit();
+
+    // From a projected frame; false (and valid false) with too few nest tags
+    // or tags that don't look like a square's edges
+    bool fit(const PerceptionFrame& frame);
+
+    void clear() { valid = false; }
+
+    bool valid;
+    double x;                               // nest center, map frame
+    double y;
+    double theta;                           // edge direction, [-pi/4, pi/4)
+    double residual;                        // rms tag to edge distance, m
+    int tags;                               // nest tags the fit used
+    int edges;                              // edges with at least two of them
+    double confidence;                      // 0..1, from tags, edges and residual
+
+private:
+    bool solve(double normal[3][3], double gradient[3], double step[3]);
+
+    double tagX[FRAME_TAGS];
+    double tagY[FRAME_TAGS];
+};
+
+#endif // NESTFIT_H
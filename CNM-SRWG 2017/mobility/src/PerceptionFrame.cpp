@@ -0,0 +1,145 @@
+#include "PerceptionFrame.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+const double CAMERAOFFSET = 0.020;                          //meters between the camera and the chassis center line
+const double CAMERAHEIGHT = 0.195;                          //meters the camera sits above the ground
+
+void PerceptionFrame::clear()
+{
+    size = 0;
+    overflow = 0;
+    nestKept = 0;
+    targetsKept = 0;
+
+    nestCount = 0;
+    nestLeft = 0;
+    nestRight = 0;
+
+    targetCount = 0;
+    targetLeft = 0;
+    targetRight = 0;
+
+    nearestTarget = -1;
+    projected = false;
+}
+
+void PerceptionFrame::build(const apriltags_ros::AprilTagDetectionArray& message)
+{
+    clear();
+
+    double nearest = 0;
+
+    for (unsigned int i = 0; i < message.detections.size(); i++)
+    {
+        const apriltags_ros::AprilTagDetection& detection = message.detections[i];
+        const geometry_msgs::Point& position = detection.pose.pose.position;
+
+        bool isRight = position.x + CAMERAOFFSET > 0;
+
+        if (detection.id == NEST_TAG_ID)
+        {
+            nestCount++;
+            if (isRight) { nestRight++; }
+            else { nestLeft++; }
+        }
+        else if (detection.id == TARGET_TAG_ID)
+        {
+            targetCount++;
+            if (isRight) { targetRight++; }
+            else { targetLeft++; }
+        }
+
+        if (size == FRAME_TAGS)
+        {
+            overflow++;
+            continue;
+        }
+
+        int tag = size++;
+
+        id[tag] = detection.id;
+        x[tag] = position.x;
+        y[tag] = position.y;
+        z[tag] = position.z;
+        right[tag] = isRight;
+
+        range[tag] = sqrt(position.x * position.x + position.y * position.y + position.z * position.z);
+
+        //the camera looks down from CAMERAHEIGHT, take that out of the distance
+        //(a tag closer than that is under the camera, no distance at all)
+        double slant = position.y * position.y + position.z * position.z;
+        distance[tag] = sqrt(max(0.0, slant - CAMERAHEIGHT * CAMERAHEIGHT));
+        bearing[tag] = atan2(position.x + CAMERAOFFSET, distance[tag]) * 1.05;
+
+        if (detection.id == NEST_TAG_ID) { nest[nestKept++] = tag; }
+        else if (detection.id == TARGET_TAG_ID)
+        {
+            targets[targetsKept++] = tag;
+
+            if (nearestTarget < 0 || range[tag] < nearest)
+            {
+                nearestTarget = tag;
+                nearest = range[tag];
+            }
+        }
+    }
+}
+
+//where a tag is on the ground relative to the chassis: ahead of it and to its right
+static void chassisOffset(const PerceptionFrame& frame, int tag, double& ahead, double& right)
+{
+    ahead = frame.distance[tag];
+    right = frame.x[tag] + CAMERAOFFSET;
+}
+
+void PerceptionFrame::project(const geometry_msgs::Pose2D& odometry, const geometry_msgs::Pose2D& map)
+{
+    this->odometry = odometry;
+    this->map = map;
+
+    double odometryCos = cos(odometry.theta);
+    double odometrySin = sin(odometry.theta);
+    double mapCos = cos(map.theta);
+    double mapSin = sin(map.theta);
+
+    for (int tag = 0; tag < size; tag++)
+    {
+        double ahead, right;
+        chassisOffset(*this, tag, ahead, right);
+
+        odometryX[tag] = odometry.x + ahead * odometryCos + right * odometrySin;
+        odometryY[tag] = odometry.y + ahead * odometrySin - right * odometryCos;
+        mapX[tag] = map.x + ahead * mapCos + right * mapSin;
+        mapY[tag] = map.y + ahead * mapSin - right * mapCos;
+    }
+
+    projected = true;
+}
+
+bool PerceptionFrame::seenFrom(int tag, const geometry_msgs::Pose2D& pose, double& tagDistance, double& tagBearing) const
+{
+    if (!projected || tag < 0 || tag >= size) { return false; }
+
+    return seenFrom(odometryX[tag], odometryY[tag], pose, tagDistance, tagBearing);
+}
+
+bool PerceptionFrame::seenFrom(double x, double y, const geometry_msgs::Pose2D& pose, double& tagDistance, double& tagBearing)
+{
+    double dx = x - pose.x;
+    double dy = y - pose.y;
+
+    double ahead = dx * cos(pose.theta) + dy * sin(pose.theta);
+    double right = dx * sin(pose.theta) - dy * cos(pose.theta);
+
+    //NaN too, a tag right under the camera has no ground distance
+    if (!(ahead > 0)) { return false; }
+
+    tagDistance = ahead;
+    tagBearing = atan(right / ahead) * 1.05;
+
+    return true;
+}
@@ -0,0 +1,81 @@
+#ifndef PERCEPTIONFRAME_H
+#define PERCEPTIONFRAME_H
+
+#include <geometry_msgs/Pose2D.h>
+#include <apriltags_ros/AprilTagDetectionArray.h>
+
+/**
+ * One camera frame of AprilTag detections, boiled down in a single pass to
+ * everything the pickup, drop off and centering code looks at, so nothing
+ * walks or copies the detection array again.
+ *
+ * The per tag values are kept as a struct of arrays, preallocated for
+ * FRAME_TAGS tags; a frame with more (the nest filling the view) still
+ * counts every tag but only keeps the first FRAME_TAGS.  Positions are in
+ * the camera frame: x right, y down, z forward.
+ *
+ * project() places every kept tag in the odometry and map frames using the
+ * poses the rover had when the image was taken, and seenFrom() turns such a
+ * position back into a distance and bearing from wherever the rover is now.
+ */
+
+static const int FRAME_TAGS = 128;
+
+static const int TARGET_TAG_ID = 0;
+static const int NEST_TAG_ID = 256;
+
+struct PerceptionFrame {
+    PerceptionFrame() { clear(); }
+
+    void clear();
+    void build(const apriltags_ros::AprilTagDetectionArray& message);
+
+    // odometry/map are the rover's poses at the time the image was taken
+    void project(const geometry_msgs::Pose2D& odometry, const geometry_msgs::Pose2D& map);
+
+    // distance and bearing (as in the arrays) of a projected tag, or of a
+    // point on the ground, from an odometry pose.  False if it is not in
+    // front of the rover any more.
+    bool seenFrom(int tag, const geometry_msgs::Pose2D& pose, double& tagDistance, double& tagBearing) const;
+    static bool seenFrom(double x, double y, const geometry_msgs::Pose2D& pose, double& tagDistance, double& tagBearing);
+
+    int size;                               // tags kept in the arrays below
+    int overflow;                           // tags past FRAME_TAGS, counted but not kept
+
+    //per tag, in detection order
+    int id[FRAME_TAGS];
+    double x[FRAME_TAGS];
+    double y[FRAME_TAGS];
+    double z[FRAME_TAGS];
+    double range[FRAME_TAGS];               // from the camera lens
+    double distance[FRAME_TAGS];            // from the bottom center of the chassis, ignoring height, 0 under the camera
+    double bearing[FRAME_TAGS];             // angle to the tag from the bottom center of the chassis, radians
+    bool right[FRAME_TAGS];                 // right half of the image, after the camera offset
+
+    //nest and target tags, as indices into the arrays above
+    int nest[FRAME_TAGS];
+    int nestKept;                           // entries in nest
+    int targets[FRAME_TAGS];
+    int targetsKept;
+
+    int nestCount;                          // every tag in the frame, kept or not
+    int nestLeft;
+    int nestRight;
+
+    int targetCount;
+    int targetLeft;
+    int targetRight;
+
+    int nearestTarget;                      // index of the target closest to the camera, -1 without one
+
+    //filled in by project()
+    bool projected;
+    geometry_msgs::Pose2D odometry;         // rover pose when the image was taken
+    geometry_msgs::Pose2D map;
+    double odometryX[FRAME_TAGS];           // tag positions on the ground
+    double odometryY[FRAME_TAGS];
+    double mapX[FRAME_TAGS];
+    double mapY[FRAME_TAGS];
+};
+
+#endif // PERCEPTIONFRAME_H
@@ -3,9 +3,11 @@
 PickUpController::PickUpController() {
     lockTarget = false;
     timeOut = false;
-    nTargetsSeen = 0;
+    millTimer = 0;
+    clock = &SteadyClock::instance();
     blockYawError = 0;
     blockDist = 0;
+    selectedTrack = -1;
     td = 0;
 
     result.pickedUp = false;
@@ -17,7 +19,13 @@ PickUpController::PickUpController() {
 
 }
 
-PickUpResult PickUpController::pickUpSelectedTarget(bool blockBlock) {
+PickUpResult PickUpController::pickUpSelectedTarget(bool blockBlock, const geometry_msgs::Pose2D& current) {
+
+    double now = clock->seconds();
+
+    //the rover kept moving since the last camera frame
+    tracker.expire(now);
+    bool blockTracked = aimAtBlock(current);
 
     //threshold distance to be from the target block before attempting pickup
     float targetDist = 0.14; //meters	//ORIGINALLY 0.22
@@ -37,14 +45,13 @@ PickUpResult PickUpController::pickUpSelectedTarget(bool blockBlock) {
   result.giveUp = false;*/
 
     // millisecond time = current time if not in a counting state
-    if (!timeOut) millTimer = ros::Time::now();
+    if (!timeOut) millTimer = now;
 
     //diffrence between current time and millisecond time
-    ros::Duration Tdiff = ros::Time::now() - millTimer;
-    float Td = Tdiff.sec + Tdiff.nsec/1000000000.0;
+    float Td = now - millTimer;
     td = Td;
 
-    if (nTargetsSeen == 0 && !lockTarget) //if not targets detected and a target has not been locked in
+    if (!blockTracked && !lockTarget) //if no target is tracked and a target has not been locked in
     {
         if(!timeOut) //if not in a counting state
         {
@@ -68,7 +75,6 @@ PickUpResult PickUpController::pickUpSelectedTarget(bool blockBlock) {
         result.cmdVel = vel;
         result.angleError = -blockYawError/2;
         timeOut = false;
-        nTargetsSeen = 0;
         return result;
     }
     else if (!lockTarget) //if a target hasn't been locked lock it and enter a counting state while slowly driving forward.
@@ -125,7 +131,13 @@ PickUpResult PickUpController::pickUpSelectedTarget(bool blockBlock) {
     return result;
 }
 
-PickUpResult PickUpController::selectTarget(const apriltags_ros::AprilTagDetectionArray::ConstPtr& message) {
+void PickUpController::track(const PerceptionFrame& frame) {
+    tracker.update(frame, clock->seconds());
+}
+
+PickUpResult PickUpController::selectTarget(const PerceptionFrame& frame, const geometry_msgs::Pose2D& current) {
+
+    double now = clock->seconds();
 
     /*PickUpResult result;
   result.pickedUp = false;
@@ -136,36 +148,29 @@ PickUpResult PickUpController::selectTarget(const apriltags_ros::AprilTagDetecti
   result.giveUp = false;*/
 
 
-    nTargetsSeen = 0;
-    nTargetsSeen = message->detections.size();
-
-    double closest = std::numeric_limits<double>::max();
-    int target  = 0;
-    for (int i = 0; i < message->detections.size(); i++) //this loop selects the closest visible block to makes goals for it
+    //stay with the block we were going for while it is tracked, otherwise take
+    //the closest one.  Distance and angle are from the bottom center of the
+    //chassis as it is now, the image is a camera and detector delay old.
+    tracker.expire(now);
+    if (!tracker.find(selectedTrack))
     {
-        geometry_msgs::PoseStamped tagPose = message->detections[i].pose;
-        double test = hypot(hypot(tagPose.pose.position.x, tagPose.pose.position.y), tagPose.pose.position.z); //absolute distance to block from camera lense
-
-        if (closest > test)
-        {
-            target = i;
-            closest = test;
-            blockDist = hypot(tagPose.pose.position.z, tagPose.pose.position.y); //distance from bottom center of chassis ignoring height.
-            blockDist = sqrt(blockDist*blockDist - 0.195*0.195);
-            blockYawError = atan((tagPose.pose.position.x + 0.020)/blockDist)*1.05; //angle to block from bottom center of chassis on the horizontal.
-        }
+        const TargetTrack* nearest = tracker.nearest(current);
+        selectedTrack = nearest ? nearest->id : -1;
     }
+
+    aimAtBlock(current);
+
     if ( blockYawError > 10) blockYawError = 10; //limits block angle error to prevent overspeed from PID.
     if ( blockYawError < - 10) blockYawError = -10; //due to detetionropping out when moveing quickly
 
-    geometry_msgs::PoseStamped tagPose = message->detections[target].pose;
-
     //if target is close enough
     //diffrence between current time and millisecond time
-    ros::Duration Tdiff = ros::Time::now() - millTimer;
-    float Td = Tdiff.sec + Tdiff.nsec/1000000000;
+    float Td = now - millTimer;
+
+    //a block right under the camera is never tracked, the frame says when it is in the claw
+    int target = frame.nearestTarget;
 
-    if (hypot(hypot(tagPose.pose.position.x, tagPose.pose.position.y), tagPose.pose.position.z) < 0.13 && Td < 3.8) {
+    if (target >= 0 && frame.range[target] < 0.13 && Td < 3.8) {
         result.pickedUp = true;
     }
 
@@ -184,13 +189,31 @@ PickUpResult PickUpController::selectTarget(const apriltags_ros::AprilTagDetecti
     return result;
 }
 
+bool PickUpController::aimAtBlock(const geometry_msgs::Pose2D& current) {
+    const TargetTrack* block = tracker.find(selectedTrack);
+    if (!block)
+    {
+        selectedTrack = -1;
+        return false;
+    }
+
+    double dist, yawError;
+    if (PerceptionFrame::seenFrom(block->x, block->y, current, dist, yawError))
+    {
+        blockDist = dist;
+        blockYawError = yawError;
+    }
+
+    return true;
+}
+
 void PickUpController::reset() {
     result.pickedUp = false;
     lockTarget = false;
     timeOut = false;
-    nTargetsSeen = 0;
     blockYawError = 0;
     blockDist = 0;
+    selectedTrack = -1;
     td = 0;
 
     result.pickedUp = false;
@@ -1,8 +1,9 @@
 #ifndef PICKUPCONTROLLER_H
 #define PICKUPCONTROLLER_H
 #define HEADERFILE_H
-#include <apriltags_ros/AprilTagDetectionArray.h>
-#include <ros/ros.h>
+#include "Clock.h"
+#include "PerceptionFrame.h"
+#include "TargetTracker.h"
 
 struct PickUpResult {
   float cmdVel;
@@ -19,12 +20,22 @@ class PickUpController
   PickUpController();
   ~PickUpController();
 
-  PickUpResult selectTarget(const apriltags_ros::AprilTagDetectionArray::ConstPtr& message);
-  PickUpResult pickUpSelectedTarget(bool blockBlock);
+  //time comes from clock (the SteadyClock until told otherwise)
+  void setClock(const Clock* clock) { this->clock = clock; }
+
+  //every projected camera frame, with targets in it or not
+  void track(const PerceptionFrame& frame);
+
+  //goes for the tracked target closest to current (the odometry pose now),
+  //or keeps going for the one already picked while it is still tracked.
+  //Whether a block is in the claw is up to the frame itself.
+  PickUpResult selectTarget(const PerceptionFrame& frame, const geometry_msgs::Pose2D& current);
+  PickUpResult pickUpSelectedTarget(bool blockBlock, const geometry_msgs::Pose2D& current);
 
   float getDist() {return blockDist;}
   bool getLockTarget() {return lockTarget;}
   float getTD() {return td;}
+  const TargetTracker& getTracker() {return tracker;}
 
   void reset();
 
@@ -35,8 +46,8 @@ private:
 
   // Failsafe state. No legitimate behavior state. If in this state for too long return to searching as default behavior.
   bool timeOut;
-  int nTargetsSeen;
-  ros::Time millTimer;
+  double millTimer;
+  const Clock* clock;
 
   //yaw error to target block 
   double blockYawError;
@@ -44,6 +55,14 @@ private:
   //distance to target block from front of robot
   double blockDist;
 
+  //the target blocks in the odometry frame, and the one we are going for
+  //(a track id, -1 for none).  The distance and yaw error follow the rover
+  //between camera frames and through a frame or two without the block.
+  TargetTracker tracker;
+  int selectedTrack;
+
+  bool aimAtBlock(const geometry_msgs::Pose2D& current);    //false when the block is no longer tracked
+
   //struct for returning data to mobility
   PickUpResult result;
 
@@ -0,0 +1,68 @@
+#include "PoseHistory.h"
+
+#include <angles/angles.h>
+
+using namespace std;
+
+PoseHistory::PoseHistory(unsigned int capacity) : samples(capacity)
+{
+    this->capacity = capacity;
+    head = 0;
+    size = 0;
+}
+
+void PoseHistory::add(double time, const geometry_msgs::Pose2D& pose)
+{
+    if (size > 0 && time <= newest()) { return; }
+
+    Sample& slot = samples[(head + size) % capacity];
+    slot.time = time;
+    slot.pose = pose;
+
+    if (size < capacity) { size++; }
+    else { head = (head + 1) % capacity; }
+}
+
+double PoseHistory::oldest() const
+{
+    return size > 0 ? sample(0).time : 0;
+}
+
+double PoseHistory::newest() const
+{
+    return size > 0 ? sample(size - 1).time : 0;
+}
+
+bool PoseHistory::at(double time, geometry_msgs::Pose2D& pose) const
+{
+    if (size == 0 || time < oldest()) { return false; }
+
+    if (time >= newest())
+    {
+        pose = sample(size - 1).pose;
+        return true;
+    }
+
+    //first sample newer than time, the one before it is at or before time
+    unsigned int low = 0;
+    unsigned int high = size - 1;
+
+    while (low < high)
+    {
+        unsigned int middle = (low + high) / 2;
+
+        if (sample(middle).time > time) { high = middle; }
+        else { low = middle + 1; }
+    }
+
+    const Sample& before = sample(high - 1);
+    const Sample& after = sample(high);
+
+    double t = (time - before.time) / (after.time - before.time);
+
+    pose.x = before.pose.x + (after.pose.x - before.pose.x) * t;
+    pose.y = before.pose.y + (after.pose.y - before.pose.y) * t;
+    pose.theta = angles::normalize_angle(before.pose.theta + angles::shortest_angular_distance(before.pose.theta, after.pose.theta) * t);
+
+    return true;
+}
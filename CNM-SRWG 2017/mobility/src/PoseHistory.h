@@ -0,0 +1,47 @@
+#ifndef POSEHISTORY_H
+#define POSEHISTORY_H
+
+#include <vector>
+#include <geometry_msgs/Pose2D.h>
+
+/**
+ * The last N poses of one frame (odometry or map) by the time they were
+ * measured, so something seen a while ago (a camera frame that took the
+ * AprilTag detector a few hundred ms) can be placed using where the rover
+ * was when it was seen, not where it is now.
+ *
+ * Poses have to be added in time order; one that is not newer than the
+ * last is dropped.  Between two poses the position is interpolated
+ * linearly and the heading along the shorter way round.
+ */
+class PoseHistory
+{
+public:
+    PoseHistory(unsigned int capacity);
+
+    void add(double time, const geometry_msgs::Pose2D& pose);
+    void clear() { size = 0; }
+
+    // The pose at time.  Past the newest pose that is the newest pose; false
+    // (pose left alone) when time is older than anything kept or nothing is.
+    bool at(double time, geometry_msgs::Pose2D& pose) const;
+
+    unsigned int count() const { return size; }
+    double oldest() const;                  // time of the oldest pose, 0 when empty
+    double newest() const;
+
+private:
+    struct Sample {
+        double time;
+        geometry_msgs::Pose2D pose;
+    };
+
+    const Sample& sample(unsigned int i) const { return samples[(head + i) % capacity]; }   // 0 is the oldest
+
+    std::vector<Sample> samples;
+    unsigned int capacity;
+    unsigned int head;                      // oldest sample
+    unsigned int size;
+};
+
+#endif // POSEHISTORY_H
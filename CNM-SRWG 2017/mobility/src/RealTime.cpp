@@ -0,0 +1,75 @@
+#include "mobility/RealTime.h"
+
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+using namespace std;
+
+static string describe(const char* what, int code)
+{
+    stringstream ss;
+    ss << what << ": " << strerror(code);
+    return ss.str();
+}
+
+// Writes every page of a stack sized buffer so they are mapped (and, after
+// mlockall, locked) now rather than on the first deep call inside the loop.
+// The pages are read back so the writes can't be dropped.
+static char __attribute__((noinline)) prefaultStack()
+{
+    volatile char buffer[PREFAULT_STACK];
+    char sum = 0;
+
+    for (unsigned int i = 0; i < PREFAULT_STACK; i += 4096) { buffer[i] = 0; }
+    for (unsigned int i = 0; i < PREFAULT_STACK; i += 4096) { sum += buffer[i]; }
+
+    return sum;
+}
+
+bool lockProcessMemory(string& error)
+{
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+    {
+        error = describe("mlockall", errno);
+        return false;
+    }
+
+    return true;
+}
+
+bool makeThreadRealTime(const RealTimeConfig& config, string& error)
+{
+    if (config.cpu >= 0)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(config.cpu, &cpus);
+
+        int result = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (result != 0)
+        {
+            error = describe("pinning to a cpu", result);
+            return false;
+        }
+    }
+
+    sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = config.priority;
+
+    int result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (result != 0)
+    {
+        error = describe("SCHED_FIFO", result);
+        return false;
+    }
+
+    prefaultStack();
+
+    return true;
+}
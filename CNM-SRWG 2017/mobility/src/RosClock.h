@@ -0,0 +1,15 @@
+#ifndef ROSCLOCK_H
+#define ROSCLOCK_H
+
+#include <ros/ros.h>
+
+#include "Clock.h"
+
+// ros::Time::now(), so sim time when /use_sim_time is set
+class RosClock : public Clock
+{
+public:
+    virtual int64_t nanoseconds() const { return ros::Time::now().toNSec(); }
+};
+
+#endif // ROSCLOCK_H
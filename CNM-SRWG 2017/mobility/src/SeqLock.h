@@ -0,0 +1,57 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+
+// Single writer, many reader snapshot of a small plain-old-data value.
+//
+// The writer never waits and readers never take a lock: a reader copies the
+// value and retries only if the writer was in the middle of an update while
+// it was copying.  Meant for handing the latest sample of something (a
+// transform, a pose, a goal) from one thread to another.
+template <typename T>
+class SeqLock
+{
+public:
+    SeqLock() : sequence(0), value() {}
+
+    // Only ever call from one thread at a time.
+    void store(const T& newValue)
+    {
+        unsigned int seq = sequence.load(std::memory_order_relaxed);
+
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        value = newValue;
+
+        std::atomic_thread_fence(std::memory_order_release);
+        sequence.store(seq + 2, std::memory_order_relaxed);
+    }
+
+    T load() const
+    {
+        T copy;
+        unsigned int before, after;
+
+        do
+        {
+            before = sequence.load(std::memory_order_acquire);
+            copy = value;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+        }
+        while (before != after || (before & 1));
+
+        return copy;
+    }
+
+    // Number of completed stores, lets a reader tell if anything new arrived.
+    unsigned int version() const { return sequence.load(std::memory_order_acquire) >> 1; }
+
+private:
+    std::atomic<unsigned int> sequence;
+    T value;
+};
+
+#endif // SEQLOCK_H
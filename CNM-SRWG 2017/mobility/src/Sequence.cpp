@@ -0,0 +1,106 @@
+#include "Sequence.h"
+
+Sequence::Sequence()
+{
+    running = false;
+    lastTimedOut = false;
+    current = 0;
+    stepStart = 0;
+    generation = 0;
+}
+
+Sequence& Sequence::then(const Action& action)
+{
+    Step step;
+    step.action = action;
+    step.timeout = -1;
+    steps.push_back(step);
+
+    return *this;
+}
+
+Sequence& Sequence::wait(double seconds)
+{
+    Step step;
+    step.timeout = seconds;
+    steps.push_back(step);
+
+    return *this;
+}
+
+Sequence& Sequence::until(const Condition& done, double timeout, const Action& action)
+{
+    Step step;
+    step.action = action;
+    step.done = done;
+    step.timeout = timeout;
+    steps.push_back(step);
+
+    return *this;
+}
+
+void Sequence::start(double now)
+{
+    generation++;
+    current = 0;
+    lastTimedOut = false;
+    running = !steps.empty();
+
+    enter(now);
+}
+
+void Sequence::update(double now)
+{
+    if (!running || !finished(now)) { return; }
+
+    current++;
+    enter(now);
+}
+
+void Sequence::cancel()
+{
+    if (!running) { return; }
+
+    running = false;
+    generation++;
+}
+
+void Sequence::enter(double now)
+{
+    while (running && current < steps.size())
+    {
+        stepStart = now;
+
+        unsigned long startedAs = generation;
+        if (steps[current].action) { steps[current].action(); }
+
+        //the action cancelled or restarted us, whoever did is in charge now
+        if (generation != startedAs) { return; }
+
+        if (!finished(now)) { return; }
+
+        current++;
+    }
+
+    running = false;
+}
+
+bool Sequence::finished(double now)
+{
+    const Step& step = steps[current];
+
+    if (step.done && step.done())
+    {
+        lastTimedOut = false;
+        return true;
+    }
+
+    if (step.timeout >= 0 && now - stepStart >= step.timeout)
+    {
+        lastTimedOut = step.done ? true : false;
+        return true;
+    }
+
+    //nothing to wait for
+    return !step.done && step.timeout < 0;
+}
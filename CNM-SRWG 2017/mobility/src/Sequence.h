@@ -0,0 +1,77 @@
+#ifndef SEQUENCE_H
+#define SEQUENCE_H
+
+#include <functional>
+#include <vector>
+
+/**
+ * A behaviour written as a list of steps that runs one after the other off
+ * the control loop, instead of a chain of timers whose callbacks start each
+ * other.
+ *
+ * Each step runs its start action once and then waits until its condition
+ * holds or its timeout runs out, whichever comes first.  A step without a
+ * condition just waits out its timeout, a step with neither is done as soon
+ * as its action ran, so
+ *
+ *     seq.wait(10).then(driveForward).until(goalReached, 10).then(turnAround)
+ *
+ * waits 10 s, drives forward until the goal is reached (giving up after
+ * 10 s) and turns around.  Steps that are done straight away run in the same
+ * update(), so a chain of actions happens within one cycle.
+ *
+ * cancel() stops the sequence where it is.  It is safe to call (or start()
+ * again) from inside one of the steps.
+ */
+class Sequence
+{
+public:
+    typedef std::function<void()> Action;
+    typedef std::function<bool()> Condition;
+
+    Sequence();
+
+    // Building, only while the sequence is not running
+    Sequence& then(const Action& action);
+    Sequence& wait(double seconds);
+    Sequence& until(const Condition& done, double timeout, const Action& action = Action());
+
+    // (Re)starts from the first step, running every step that is done
+    // straight away
+    void start(double now);
+
+    // Moves on to the next step(s) once the current one is done
+    void update(double now);
+
+    // Does nothing if the sequence isn't running
+    void cancel();
+
+    bool isRunning() const { return running; }
+
+    // True if the last step to finish ran out of time instead of meeting its
+    // condition
+    bool timedOut() const { return lastTimedOut; }
+
+private:
+    struct Step {
+        Action action;                      // run once as the step begins
+        Condition done;                     // empty: the step only ends on its timeout
+        double timeout;                     // seconds, < 0 for none
+    };
+
+    // runs the current step's action and skips through finished steps
+    void enter(double now);
+
+    // true (and lastTimedOut set) once the current step is done
+    bool finished(double now);
+
+    std::vector<Step> steps;
+
+    bool running;
+    bool lastTimedOut;
+    unsigned int current;
+    double stepStart;
+    unsigned long generation;               // bumped by start()/cancel() so a step can tell it was interrupted
+};
+
+#endif // SEQUENCE_H
@@ -0,0 +1,212 @@
+#include "TargetTracker.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+const double GATE = 9.21;                                   //squared standard deviations, 99% for 2 dof
+const double PROCESS_NOISE = 0.05 * 0.05;                   //m^2 a second a cube seems to wander (odometry drift)
+const double MIN_MEASUREMENT_SD = 0.02;                     //meters, tag position error up close
+const double MEASUREMENT_SD_PER_METER = 0.05;               //and how it grows with range
+const double LOST_AFTER = 1.0;                              //seconds unseen while in view
+const double OCCLUDED_LOST_AFTER = 4.0;                     //seconds unseen while out of view
+const double MIN_VISIBLE_DISTANCE = 0.2;                    //meters, closer than this a cube is under the camera
+const double HALF_FIELD_OF_VIEW = 0.5;                      //radians, as a bearing
+const double MIN_CONFIDENCE = 0.05;                         //below this a track is dropped
+
+TargetTracker::TargetTracker()
+{
+    trackCount = 0;
+    nextId = 1;
+
+    candidates.reserve(FRAME_TAGS * MAX_TRACKS);
+}
+
+void TargetTracker::predict(TargetTrack& track, double now)
+{
+    if (now > track.lastPredicted)
+    {
+        track.variance += PROCESS_NOISE * (now - track.lastPredicted);
+        track.lastPredicted = now;
+    }
+}
+
+void TargetTracker::correct(TargetTrack& track, const PerceptionFrame& frame, int tag, double now)
+{
+    double sd = MIN_MEASUREMENT_SD + MEASUREMENT_SD_PER_METER * frame.range[tag];
+    double gain = track.variance / (track.variance + sd * sd);
+
+    track.x += gain * (frame.odometryX[tag] - track.x);
+    track.y += gain * (frame.odometryY[tag] - track.y);
+    track.variance *= 1 - gain;
+
+    track.lastSeen = now;
+    track.range = frame.range[tag];
+    track.occluded = false;
+    track.hits++;
+    track.confidence += 0.4 * (1 - track.confidence);
+}
+
+void TargetTracker::start(const PerceptionFrame& frame, int tag, double now)
+{
+    //full up, the least trusted track makes room
+    int slot = trackCount;
+    if (trackCount == MAX_TRACKS)
+    {
+        slot = 0;
+        for (int i = 1; i < trackCount; i++)
+        {
+            if (tracks[i].confidence < tracks[slot].confidence) { slot = i; }
+        }
+    }
+    else
+    {
+        trackCount++;
+    }
+
+    double sd = MIN_MEASUREMENT_SD + MEASUREMENT_SD_PER_METER * frame.range[tag];
+
+    TargetTrack& track = tracks[slot];
+    track.id = nextId++;
+    track.x = frame.odometryX[tag];
+    track.y = frame.odometryY[tag];
+    track.variance = sd * sd;
+    track.firstSeen = now;
+    track.lastSeen = now;
+    track.lastPredicted = now;
+    track.hits = 1;
+    track.misses = 0;
+    track.confidence = 0.4;
+    track.range = frame.range[tag];
+    track.occluded = false;
+}
+
+bool TargetTracker::inView(const TargetTrack& track, const geometry_msgs::Pose2D& pose) const
+{
+    double distance, bearing;
+    if (!PerceptionFrame::seenFrom(track.x, track.y, pose, distance, bearing)) { return false; }
+
+    return distance >= MIN_VISIBLE_DISTANCE && fabs(bearing) <= HALF_FIELD_OF_VIEW;
+}
+
+void TargetTracker::update(const PerceptionFrame& frame, double now)
+{
+    for (int i = 0; i < trackCount; i++)
+    {
+        predict(tracks[i], now);
+        trackMatched[i] = false;
+    }
+
+    //every detection/track pair inside the gate, closest first
+    candidates.clear();
+
+    for (int k = 0; k < frame.targetsKept && frame.projected; k++)
+    {
+        int tag = frame.targets[k];
+
+        //a cube under the camera has no ground position to track, it is
+        //in the claw or about to be
+        detectionMatched[tag] = !(frame.distance[tag] > 0);
+        if (detectionMatched[tag]) { continue; }
+
+        double sd = MIN_MEASUREMENT_SD + MEASUREMENT_SD_PER_METER * frame.range[tag];
+
+        for (int i = 0; i < trackCount; i++)
+        {
+            double dx = frame.odometryX[tag] - tracks[i].x;
+            double dy = frame.odometryY[tag] - tracks[i].y;
+            double distance = (dx * dx + dy * dy) / (tracks[i].variance + sd * sd);
+
+            if (distance < GATE)
+            {
+                Candidate candidate = { distance, tag, i };
+                candidates.push_back(candidate);
+            }
+        }
+    }
+
+    sort(candidates.begin(), candidates.end(), closer);
+
+    for (unsigned int c = 0; c < candidates.size(); c++)
+    {
+        const Candidate& candidate = candidates[c];
+        if (trackMatched[candidate.track] || detectionMatched[candidate.detection]) { continue; }
+
+        correct(tracks[candidate.track], frame, candidate.detection, now);
+        trackMatched[candidate.track] = true;
+        detectionMatched[candidate.detection] = true;
+    }
+
+    //tracks the camera should have seen and didn't
+    int matchedTracks = trackCount;
+    for (int i = 0; i < matchedTracks; i++)
+    {
+        if (trackMatched[i]) { continue; }
+
+        TargetTrack& track = tracks[i];
+        track.occluded = !inView(track, frame.odometry);
+
+        if (!track.occluded)
+        {
+            track.misses++;
+            track.confidence *= 0.6;
+        }
+    }
+
+    for (int k = 0; k < frame.targetsKept && frame.projected; k++)
+    {
+        int tag = frame.targets[k];
+        if (!detectionMatched[tag]) { start(frame, tag, now); }
+    }
+
+    expire(now);
+}
+
+void TargetTracker::expire(double now)
+{
+    int kept = 0;
+
+    for (int i = 0; i < trackCount; i++)
+    {
+        const TargetTrack& track = tracks[i];
+
+        double unseen = now - track.lastSeen;
+        bool lost = unseen > (track.occluded ? OCCLUDED_LOST_AFTER : LOST_AFTER) || track.confidence < MIN_CONFIDENCE;
+
+        if (!lost) { tracks[kept++] = track; }
+    }
+
+    trackCount = kept;
+}
+
+const TargetTrack* TargetTracker::find(int id) const
+{
+    for (int i = 0; i < trackCount; i++)
+    {
+        if (tracks[i].id == id) { return &tracks[i]; }
+    }
+
+    return NULL;
+}
+
+const TargetTrack* TargetTracker::nearest(const geometry_msgs::Pose2D& pose) const
+{
+    const TargetTrack* best = NULL;
+    double bestDistance = 0;
+
+    for (int i = 0; i < trackCount; i++)
+    {
+        double dx = tracks[i].x - pose.x;
+        double dy = tracks[i].y - pose.y;
+        double distance = dx * dx + dy * dy;
+
+        if (!best || distance < bestDistance)
+        {
+            best = &tracks[i];
+            bestDistance = distance;
+        }
+    }
+
+    return best;
+}
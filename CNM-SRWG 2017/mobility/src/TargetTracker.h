@@ -0,0 +1,89 @@
+#ifndef TARGETTRACKER_H
+#define TARGETTRACKER_H
+
+#include <vector>
+#include <geometry_msgs/Pose2D.h>
+
+#include "PerceptionFrame.h"
+
+/**
+ * Follows the target cubes (id 0 tags) from one camera frame to the next in
+ * the odometry frame, so a cube that drops out of a frame or two (or slides
+ * under the camera on the final approach) is still the same cube, in the
+ * same place, when it is seen again.
+ *
+ * Every track is a constant position Kalman filter (cubes don't move, the
+ * process noise covers odometry drift and nudges).  A detection updates the
+ * closest track within the gate and starts a new one otherwise.  A track the
+ * camera should have seen but didn't loses confidence; one that is out of
+ * view (too close, off to the side, behind) just waits.  Tracks not seen for
+ * LOST_AFTER seconds (OCCLUDED_LOST_AFTER if out of view) are dropped.
+ */
+
+struct TargetTrack {
+    int id;                                 // stays with the cube, never reused
+    double x;                               // odometry frame
+    double y;
+    double variance;                        // of x and of y, m^2
+
+    double firstSeen;                       // seconds, on the clock passed in
+    double lastSeen;
+    double lastPredicted;                   // time the variance was grown to
+
+    int hits;
+    int misses;                             // frames it should have been in but wasn't
+    double confidence;                      // 0..1, up on every hit, down on every miss
+
+    double range;                           // from the camera, last time it was seen
+    bool occluded;                          // out of the camera's view in the last frame
+};
+
+class TargetTracker
+{
+public:
+    static const int MAX_TRACKS = 16;
+
+    TargetTracker();
+
+    // One camera frame, projected (an empty frame only counts as a miss for
+    // the tracks in view).  Also drops the tracks that are lost by now.
+    void update(const PerceptionFrame& frame, double now);
+
+    // Drops lost tracks without a frame
+    void expire(double now);
+
+    void clear() { trackCount = 0; }
+
+    int count() const { return trackCount; }
+    const TargetTrack& track(int i) const { return tracks[i]; }
+
+    // NULL if the track is gone
+    const TargetTrack* find(int id) const;
+
+    // The track closest to an odometry pose, NULL without one
+    const TargetTrack* nearest(const geometry_msgs::Pose2D& pose) const;
+
+private:
+    struct Candidate {
+        double distance;                    // squared, in standard deviations
+        int detection;                      // tag in the frame
+        int track;
+    };
+
+    static bool closer(const Candidate& a, const Candidate& b) { return a.distance < b.distance; }
+
+    void predict(TargetTrack& track, double now);
+    void correct(TargetTrack& track, const PerceptionFrame& frame, int tag, double now);
+    void start(const PerceptionFrame& frame, int tag, double now);
+    bool inView(const TargetTrack& track, const geometry_msgs::Pose2D& pose) const;
+
+    TargetTrack tracks[MAX_TRACKS];
+    int trackCount;
+    int nextId;
+
+    std::vector<Candidate> candidates;      // scratch for update, preallocated
+    bool trackMatched[MAX_TRACKS];
+    bool detectionMatched[FRAME_TAGS];
+};
+
+#endif // TARGETTRACKER_H
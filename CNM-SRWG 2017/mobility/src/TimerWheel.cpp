@@ -0,0 +1,79 @@
+#include "TimerWheel.h"
+
+#include <algorithm>
+
+using namespace std;
+
+TimerWheel::TimerWheel(int64_t resolution, unsigned int slots)
+{
+    this->resolution = resolution;
+    this->slots.resize(slots);
+
+    current = 0;
+    scheduled = 0;
+}
+
+void TimerWheel::schedule(unsigned int id, int64_t deadline)
+{
+    if (id >= generations.size()) { generations.resize(id + 1, 0); }
+
+    Entry entry;
+    entry.id = id;
+    entry.generation = ++generations[id];
+    entry.deadline = deadline;
+    entry.order = scheduled++;
+
+    //already due, it goes out on the next advance
+    slots[slotOf(deadline < current ? current : deadline)].push_back(entry);
+}
+
+void TimerWheel::cancel(unsigned int id)
+{
+    if (id < generations.size()) { generations[id]++; }
+}
+
+void TimerWheel::collect(vector<Entry>& slot, int64_t now)
+{
+    unsigned int kept = 0;
+
+    for (unsigned int i = 0; i < slot.size(); i++)
+    {
+        const Entry& entry = slot[i];
+
+        if (entry.generation != generations[entry.id]) { continue; }                //rescheduled or cancelled
+
+        if (entry.deadline <= now) { ready.push_back(entry); }
+        else { slot[kept++] = entry; }                                              //a later turn of the wheel
+    }
+
+    slot.resize(kept);
+}
+
+bool TimerWheel::firesFirst(const Entry& a, const Entry& b)
+{
+    return a.deadline != b.deadline ? a.deadline < b.deadline : a.order < b.order;
+}
+
+void TimerWheel::advance(int64_t now, vector<unsigned int>& due)
+{
+    if (now < current) { now = current; }
+
+    ready.clear();
+
+    //every slot the time passed through, all of them if it went round the whole wheel
+    int64_t turns = now / resolution - current / resolution;
+
+    if (turns >= (int64_t)slots.size())
+    {
+        for (unsigned int i = 0; i < slots.size(); i++) { collect(slots[i], now); }
+    }
+    else
+    {
+        for (int64_t i = 0; i <= turns; i++) { collect(slots[slotOf(current + i * resolution)], now); }
+    }
+
+    current = now;
+
+    sort(ready.begin(), ready.end(), firesFirst);
+    for (unsigned int i = 0; i < ready.size(); i++) { due.push_back(ready[i].id); }
+}
@@ -0,0 +1,53 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <vector>
+#include <stdint.h>
+
+/**
+ * Hashed timing wheel: one scheduler for all of the core's timers, keyed on
+ * the time handed to the core (sim time under Gazebo).  A timer goes into
+ * the slot its deadline falls in, so scheduling, cancelling and a step with
+ * nothing due cost the same however many timers there are.
+ *
+ * advance() hands back everything that came due since the last call, in a
+ * fixed order - earliest deadline first, ties in the order they were
+ * scheduled - so the same inputs always fire the same timers the same way.
+ *
+ * Timers are small integer ids picked by the caller (0 .. ids - 1), each
+ * with at most one pending deadline.
+ */
+class TimerWheel
+{
+public:
+    // resolution is the width of a slot in nanoseconds
+    TimerWheel(int64_t resolution, unsigned int slots);
+
+    // (Re)schedules id, dropping any deadline it already had
+    void schedule(unsigned int id, int64_t deadline);
+    void cancel(unsigned int id);
+
+    // Appends the ids due at or before now to due
+    void advance(int64_t now, std::vector<unsigned int>& due);
+
+private:
+    struct Entry {
+        unsigned int id;
+        unsigned int generation;            // stale once the id is rescheduled or cancelled
+        int64_t deadline;
+        uint64_t order;                     // when it was scheduled, breaks deadline ties
+    };
+
+    unsigned int slotOf(int64_t time) const { return (unsigned int)((uint64_t)(time / resolution) % slots.size()); }
+    void collect(std::vector<Entry>& slot, int64_t now);
+    static bool firesFirst(const Entry& a, const Entry& b);
+
+    int64_t resolution;
+    std::vector<std::vector<Entry> > slots;
+    std::vector<unsigned int> generations;  // per id
+    std::vector<Entry> ready;               // due this advance, before sorting
+    int64_t current;                        // time of the last advance
+    uint64_t scheduled;
+};
+
+#endif // TIMERWHEEL_H
@@ -0,0 +1,201 @@
+#include "TraceLog.h"
+
+#include <chrono>
+
+using namespace std;
+
+static double steadySeconds()
+{
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//BUFFER
+//---------------------------------------------
+
+TraceBuffer::TraceBuffer(int thread, const char* threadName, unsigned int capacity) : head(0), tail(0), dropped(0)
+{
+    this->thread = thread;
+    this->threadName = threadName;
+
+    unsigned int size = 1;
+    while (size < capacity) { size <<= 1; }
+
+    events.resize(size);
+    mask = size - 1;
+}
+
+void TraceBuffer::span(const char* name, const char* category, double start, double end, const char* detail)
+{
+    TraceEvent event;
+    event.start = start;
+    event.duration = end - start;
+    event.name = name;
+    event.category = category;
+    event.detail = detail;
+    event.phase = 'X';
+
+    push(event);
+}
+
+void TraceBuffer::instant(const char* name, const char* category, double time, const char* detail)
+{
+    TraceEvent event;
+    event.start = time;
+    event.duration = 0;
+    event.name = name;
+    event.category = category;
+    event.detail = detail;
+    event.phase = 'i';
+
+    push(event);
+}
+
+void TraceBuffer::push(const TraceEvent& event)
+{
+    unsigned int h = head.load(memory_order_relaxed);
+
+    if (h - tail.load(memory_order_acquire) > mask)
+    {
+        dropped.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+
+    events[h & mask] = event;
+
+    head.store(h + 1, memory_order_release);
+}
+
+bool TraceBuffer::pop(TraceEvent& event)
+{
+    unsigned int t = tail.load(memory_order_relaxed);
+    if (t == head.load(memory_order_acquire)) { return false; }
+
+    event = events[t & mask];
+
+    tail.store(t + 1, memory_order_release);
+    return true;
+}
+
+//WRITER
+//---------------------------------------------
+
+TraceLog::TraceLog() : running(false)
+{
+    file = NULL;
+    firstEvent = true;
+    epoch = steadySeconds();
+    drainRate = 5;
+}
+
+TraceLog::~TraceLog()
+{
+    stop();
+
+    for (unsigned int i = 0; i < buffers.size(); i++) { delete buffers[i]; }
+}
+
+TraceBuffer* TraceLog::createBuffer(const char* threadName, unsigned int capacity)
+{
+    TraceBuffer* buffer = new TraceBuffer(buffers.size() + 1, threadName, capacity);
+    buffers.push_back(buffer);
+
+    return buffer;
+}
+
+bool TraceLog::open(const string& path)
+{
+    file = fopen(path.c_str(), "w");
+    if (!file) { return false; }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    firstEvent = true;
+
+    return true;
+}
+
+double TraceLog::now() const
+{
+    return (steadySeconds() - epoch) * 1e6;
+}
+
+void TraceLog::start(double drainRate)
+{
+    if (running || !file) { return; }
+
+    //name the threads so the timeline rows read control/perception/...
+    for (unsigned int i = 0; i < buffers.size(); i++)
+    {
+        fprintf(file, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                firstEvent ? "" : ",\n", buffers[i]->getThread(), buffers[i]->getThreadName());
+        firstEvent = false;
+    }
+
+    this->drainRate = drainRate;
+
+    running = true;
+    worker = thread(&TraceLog::writeLoop, this);
+}
+
+void TraceLog::stop()
+{
+    if (running)
+    {
+        running = false;
+        worker.join();
+    }
+
+    if (file)
+    {
+        drain();
+
+        fprintf(file, "\n]}\n");
+        fclose(file);
+        file = NULL;
+    }
+}
+
+void TraceLog::writeLoop()
+{
+    chrono::duration<double> period(1.0 / drainRate);
+
+    while (running)
+    {
+        this_thread::sleep_for(period);
+        drain();
+    }
+}
+
+void TraceLog::drain()
+{
+    if (!file) { return; }
+
+    TraceEvent event;
+
+    for (unsigned int i = 0; i < buffers.size(); i++)
+    {
+        while (buffers[i]->pop(event)) { write(buffers[i]->getThread(), event); }
+
+        uint64_t dropped = buffers[i]->takeDropped();
+        if (dropped > 0)
+        {
+            fprintf(file, ",\n{\"ph\":\"i\",\"s\":\"t\",\"name\":\"trace dropped\",\"cat\":\"trace\",\"pid\":1,\"tid\":%d,\"ts\":%.1f,\"args\":{\"count\":%llu}}",
+                    buffers[i]->getThread(), now(), (unsigned long long)dropped);
+        }
+    }
+
+    fflush(file);
+}
+
+void TraceLog::write(int thread, const TraceEvent& event)
+{
+    fprintf(file, "%s{\"ph\":\"%c\",\"name\":\"%s\",\"cat\":\"%s\",\"pid\":1,\"tid\":%d,\"ts\":%.1f",
+            firstEvent ? "" : ",\n", event.phase, event.name, event.category, thread, event.start);
+    firstEvent = false;
+
+    if (event.phase == 'X') { fprintf(file, ",\"dur\":%.1f", event.duration); }
+    else { fprintf(file, ",\"s\":\"t\""); }
+
+    if (event.detail) { fprintf(file, ",\"args\":{\"detail\":\"%s\"}", event.detail); }
+
+    fprintf(file, "}");
+}
@@ -0,0 +1,115 @@
+#ifndef TRACELOG_H
+#define TRACELOG_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Optional timeline of what the node's threads did, written as Trace Event
+ * Format JSON (load it in chrome://tracing or ui.perfetto.dev).
+ *
+ * Every thread gets its own TraceBuffer (preallocated, single producer) and
+ * only fills in fixed size TraceEvents there; names must be string literals
+ * or other strings that outlive the TraceLog.  The TraceLog writer thread
+ * drains the buffers a few times a second and does all the formatting.
+ *
+ * Times are microseconds on the steady clock since the TraceLog was made.
+ */
+
+struct TraceEvent {
+    double start;                           // microseconds, see TraceLog::now()
+    double duration;                        // spans only
+    const char* name;
+    const char* category;
+    const char* detail;                     // shown as args.detail, may be NULL
+    char phase;                             // 'X' span, 'i' instant
+};
+
+class TraceBuffer
+{
+public:
+    TraceBuffer(int thread, const char* threadName, unsigned int capacity);
+
+    void span(const char* name, const char* category, double start, double end, const char* detail = NULL);
+    void instant(const char* name, const char* category, double time, const char* detail = NULL);
+
+    // Writer side only
+    bool pop(TraceEvent& event);
+    uint64_t takeDropped() { return dropped.exchange(0, std::memory_order_relaxed); }
+
+    int getThread() { return thread; }
+    const char* getThreadName() { return threadName; }
+
+private:
+    void push(const TraceEvent& event);
+
+    int thread;
+    const char* threadName;
+    std::vector<TraceEvent> events;
+    unsigned int mask;                      // capacity - 1, capacity is a power of two
+    std::atomic<unsigned int> head;         // next slot to write (producer)
+    std::atomic<unsigned int> tail;         // next slot to read (writer)
+    std::atomic<uint64_t> dropped;
+};
+
+class TraceLog
+{
+public:
+    TraceLog();
+    ~TraceLog();
+
+    // Setup, all before start()
+    TraceBuffer* createBuffer(const char* threadName, unsigned int capacity = 4096);
+    bool open(const std::string& path);     // false if the file could not be created
+
+    // drainRate in Hz
+    void start(double drainRate);
+
+    // Drains whatever is left and closes the JSON off
+    void stop();
+
+    // Trace time, any thread
+    double now() const;
+
+private:
+    void writeLoop();
+    void drain();
+    void write(int thread, const TraceEvent& event);
+
+    std::vector<TraceBuffer*> buffers;
+    FILE* file;
+    bool firstEvent;
+    double epoch;                           // steady clock seconds at construction
+
+    double drainRate;
+    std::atomic<bool> running;
+    std::thread worker;
+};
+
+// Times the enclosing scope into buffer, does nothing with a NULL buffer
+class TraceSpan
+{
+public:
+    TraceSpan(const TraceLog& log, TraceBuffer* buffer, const char* name, const char* category) :
+        log(log), buffer(buffer), name(name), category(category), start(buffer ? log.now() : 0) {}
+
+    ~TraceSpan()
+    {
+        if (buffer) { buffer->span(name, category, start, log.now()); }
+    }
+
+    double getStart() const { return start; }
+
+private:
+    const TraceLog& log;
+    TraceBuffer* buffer;
+    const char* name;
+    const char* category;
+    double start;
+};
+
+#endif // TRACELOG_H
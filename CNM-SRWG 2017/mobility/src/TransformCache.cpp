@@ -0,0 +1,120 @@
+#include "TransformCache.h"
+
+TransformCache::TransformCache(tf::TransformListener* listener, std::string targetFrame, std::string sourceFrame)
+{
+    this->listener = listener;
+    this->targetFrame = targetFrame;
+    this->sourceFrame = sourceFrame;
+
+    refreshRate = 10;
+    lookupTimeout = 1.0;
+
+    running = false;
+    failures = 0;
+
+    CachedTransform empty;
+    empty.valid = false;
+    empty.stamp = 0;
+    empty.updated = 0;
+    empty.lookupSeconds = 0;
+    empty.origin[0] = empty.origin[1] = empty.origin[2] = 0;
+    empty.rotation[0] = empty.rotation[1] = empty.rotation[2] = 0;
+    empty.rotation[3] = 1;
+    latest.store(empty);
+}
+
+TransformCache::~TransformCache()
+{
+    stop();
+}
+
+void TransformCache::start(double refreshRate, double lookupTimeout)
+{
+    if (running) { return; }
+
+    this->refreshRate = refreshRate;
+    this->lookupTimeout = lookupTimeout;
+
+    running = true;
+    worker = std::thread(&TransformCache::refreshLoop, this);
+}
+
+void TransformCache::stop()
+{
+    running = false;
+
+    if (worker.joinable()) { worker.join(); }
+}
+
+void TransformCache::refreshLoop()
+{
+    ros::WallRate rate(refreshRate);
+
+    while (running && ros::ok())
+    {
+        ros::WallTime lookupStart = ros::WallTime::now();
+
+        try
+        {
+            //all the waiting on tf happens here, off the control loop
+            tf::StampedTransform stamped;
+            listener->waitForTransform(targetFrame, sourceFrame, ros::Time(0), ros::Duration(lookupTimeout));
+            listener->lookupTransform(targetFrame, sourceFrame, ros::Time(0), stamped);
+
+            CachedTransform entry;
+            entry.valid = true;
+            entry.stamp = stamped.stamp_.toSec();
+            entry.updated = ros::Time::now().toSec();
+            entry.lookupSeconds = (ros::WallTime::now() - lookupStart).toSec();
+
+            tf::Vector3 origin = stamped.getOrigin();
+            entry.origin[0] = origin.x();
+            entry.origin[1] = origin.y();
+            entry.origin[2] = origin.z();
+
+            tf::Quaternion rotation = stamped.getRotation();
+            entry.rotation[0] = rotation.x();
+            entry.rotation[1] = rotation.y();
+            entry.rotation[2] = rotation.z();
+            entry.rotation[3] = rotation.w();
+
+            latest.store(entry);
+        }
+        catch (tf::TransformException& ex)
+        {
+            //keep the last good transform, it just gets older
+            failures++;
+            ROS_WARN_THROTTLE(5, "TransformCache could not look up %s -> %s: %s", sourceFrame.c_str(), targetFrame.c_str(), ex.what());
+        }
+
+        rate.sleep();
+    }
+}
+
+bool TransformCache::transform(const geometry_msgs::Pose2D& in, geometry_msgs::Pose2D& out, double maxAge) const
+{
+    CachedTransform entry = latest.load();
+
+    if (!entry.valid) { return false; }
+    if (maxAge > 0 && ros::Time::now().toSec() - entry.stamp > maxAge) { return false; }
+
+    tf::Transform cached(tf::Quaternion(entry.rotation[0], entry.rotation[1], entry.rotation[2], entry.rotation[3]),
+                         tf::Vector3(entry.origin[0], entry.origin[1], entry.origin[2]));
+
+    tf::Vector3 position = cached * tf::Vector3(in.x, in.y, 0);
+
+    out.x = position.x();
+    out.y = position.y();
+    out.theta = in.theta + tf::getYaw(cached.getRotation());
+
+    return true;
+}
+
+double TransformCache::getAge() const
+{
+    CachedTransform entry = latest.load();
+
+    if (!entry.valid) { return -1; }
+
+    return ros::Time::now().toSec() - entry.stamp;
+}
@@ -0,0 +1,69 @@
+#ifndef TRANSFORMCACHE_H
+#define TRANSFORMCACHE_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include <ros/ros.h>
+#include <tf/transform_listener.h>
+#include <geometry_msgs/Pose2D.h>
+
+#include "SeqLock.h"
+
+// Latest transform held by the cache.  Plain data so it can live in a SeqLock.
+struct CachedTransform {
+  bool valid;             // at least one lookup has succeeded
+  double stamp;           // time of the transform itself (ros time, seconds)
+  double updated;         // when the background thread stored it (ros time, seconds)
+  double lookupSeconds;   // how long the lookup that produced it took
+  double origin[3];
+  double rotation[4];     // x, y, z, w
+};
+
+/**
+ * Keeps the latest target <- source transform (map -> odom for mobility)
+ * refreshed on a background thread so the control loop never has to wait on
+ * tf.  Reading the cached value is constant time and never blocks.
+ */
+class TransformCache
+{
+public:
+  TransformCache(tf::TransformListener* listener, std::string targetFrame, std::string sourceFrame);
+  ~TransformCache();
+
+  // refreshRate in Hz, lookupTimeout is how long the background thread may wait on tf
+  void start(double refreshRate, double lookupTimeout);
+  void stop();
+
+  CachedTransform get() const { return latest.load(); }
+
+  // Transforms a pose from the source frame into the target frame using the
+  // cached transform.  Returns false, and leaves out untouched, if no valid
+  // transform is available or it is older than maxAge seconds (maxAge <= 0
+  // disables the age check).
+  bool transform(const geometry_msgs::Pose2D& in, geometry_msgs::Pose2D& out, double maxAge) const;
+
+  // Age of the cached transform relative to now, in seconds
+  double getAge() const;
+
+  int getFailureCount() const { return failures.load(); }
+
+private:
+  void refreshLoop();
+
+  tf::TransformListener* listener;
+  std::string targetFrame;
+  std::string sourceFrame;
+
+  double refreshRate;
+  double lookupTimeout;
+
+  SeqLock<CachedTransform> latest;
+
+  std::atomic<bool> running;
+  std::atomic<int> failures;
+  std::thread worker;
+};
+
+#endif // TRANSFORMCACHE_H
@@ -0,0 +1,218 @@
+#include "WindowedStats.h"
+
+#include <cmath>
+
+WindowedStats::WindowedStats(unsigned int capacity)
+{
+    if (capacity < 1) { capacity = 1; }
+
+    this->capacity = capacity;
+    window.resize(capacity);
+
+    decay = 1.0;
+    decayToCapacity = 1.0;
+
+    outlierSigmas = 0;
+    outlierMinSamples = 0;
+    outlierMinDistance = 0;
+
+    clear();
+}
+
+void WindowedStats::setDecay(double decay)
+{
+    if (decay <= 0 || decay > 1) { decay = 1.0; }
+
+    this->decay = decay;
+    decayToCapacity = pow(decay, (double)capacity);
+
+    //weights of everything already in the window change, rebuild the sums
+    resync();
+}
+
+void WindowedStats::setOutlierRejection(double sigmas, unsigned int minSamples, double minDistance)
+{
+    outlierSigmas = sigmas;
+    outlierMinSamples = minSamples;
+    outlierMinDistance = minDistance;
+}
+
+bool WindowedStats::add(double x, double y, double theta)
+{
+    //OUTLIER REJECTION
+    //---------------------------------------------
+    if (outlierSigmas > 0 && size >= outlierMinSamples && size > 0)
+    {
+        double limit = outlierSigmas * spread();
+        if (limit < outlierMinDistance) { limit = outlierMinDistance; }
+
+        if (hypot(x - meanX(), y - meanY()) > limit)
+        {
+            rejected++;
+            return false;
+        }
+    }
+
+    Sample sample;
+    sample.x = x;
+    sample.y = y;
+    sample.sinTheta = sin(theta);
+    sample.cosTheta = cos(theta);
+
+    //INCREMENTAL UPDATE
+    //---------------------------------------------
+    //age everything by one step, add the new sample and, if the window is
+    //full, take out the sample that is being overwritten
+    weight = decay * weight + 1;
+    weightSquared = decay * decay * weightSquared + 1;
+    sumX = decay * sumX + sample.x;
+    sumY = decay * sumY + sample.y;
+    sumXX = decay * sumXX + sample.x * sample.x;
+    sumYY = decay * sumYY + sample.y * sample.y;
+    sumSin = decay * sumSin + sample.sinTheta;
+    sumCos = decay * sumCos + sample.cosTheta;
+
+    if (full())
+    {
+        const Sample& old = window[head];
+
+        weight -= decayToCapacity;
+        weightSquared -= decayToCapacity * decayToCapacity;
+        sumX -= decayToCapacity * old.x;
+        sumY -= decayToCapacity * old.y;
+        sumXX -= decayToCapacity * old.x * old.x;
+        sumYY -= decayToCapacity * old.y * old.y;
+        sumSin -= decayToCapacity * old.sinTheta;
+        sumCos -= decayToCapacity * old.cosTheta;
+    }
+    else
+    {
+        size++;
+    }
+
+    window[head] = sample;
+    head = (head + 1) % capacity;
+
+    //once per window length rebuild the sums so rounding error can't pile up,
+    //still constant time per sample on average
+    addsSinceResync++;
+    if (addsSinceResync >= capacity) { resync(); }
+
+    return true;
+}
+
+void WindowedStats::clear()
+{
+    head = 0;
+    size = 0;
+    addsSinceResync = 0;
+    rejected = 0;
+
+    weight = 0;
+    weightSquared = 0;
+    sumX = 0;
+    sumY = 0;
+    sumXX = 0;
+    sumYY = 0;
+    sumSin = 0;
+    sumCos = 0;
+}
+
+void WindowedStats::resync()
+{
+    addsSinceResync = 0;
+
+    weight = 0;
+    weightSquared = 0;
+    sumX = 0;
+    sumY = 0;
+    sumXX = 0;
+    sumYY = 0;
+    sumSin = 0;
+    sumCos = 0;
+
+    //oldest to newest so each step ages the earlier samples by one
+    for (unsigned int i = 0; i < size; i++)
+    {
+        const Sample& s = window[(head + capacity - size + i) % capacity];
+
+        weight = decay * weight + 1;
+        weightSquared = decay * decay * weightSquared + 1;
+        sumX = decay * sumX + s.x;
+        sumY = decay * sumY + s.y;
+        sumXX = decay * sumXX + s.x * s.x;
+        sumYY = decay * sumYY + s.y * s.y;
+        sumSin = decay * sumSin + s.sinTheta;
+        sumCos = decay * sumCos + s.cosTheta;
+    }
+}
+
+double WindowedStats::meanX() const
+{
+    if (size == 0) { return 0; }
+    return sumX / weight;
+}
+
+double WindowedStats::meanY() const
+{
+    if (size == 0) { return 0; }
+    return sumY / weight;
+}
+
+double WindowedStats::meanTheta() const
+{
+    if (size == 0) { return 0; }
+    return atan2(sumSin, sumCos);
+}
+
+geometry_msgs::Pose2D WindowedStats::mean() const
+{
+    geometry_msgs::Pose2D pose;
+
+    pose.x = meanX();
+    pose.y = meanY();
+    pose.theta = meanTheta();
+
+    return pose;
+}
+
+double WindowedStats::varianceX() const
+{
+    if (size == 0) { return 0; }
+
+    double m = meanX();
+    double variance = sumXX / weight - m * m;
+
+    return variance > 0 ? variance : 0;
+}
+
+double WindowedStats::varianceY() const
+{
+    if (size == 0) { return 0; }
+
+    double m = meanY();
+    double variance = sumYY / weight - m * m;
+
+    return variance > 0 ? variance : 0;
+}
+
+double WindowedStats::spread() const
+{
+    return sqrt(varianceX() + varianceY());
+}
+
+double WindowedStats::standardError() const
+{
+    if (size == 0) { return INFINITY; }
+
+    //effective number of samples once the weighting is taken into account
+    double effectiveCount = (weight * weight) / weightSquared;
+
+    return spread() / sqrt(effectiveCount);
+}
+
+double WindowedStats::headingConcentration() const
+{
+    if (size == 0) { return 0; }
+    return hypot(sumSin, sumCos) / weight;
+}
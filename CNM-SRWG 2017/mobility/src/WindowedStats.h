@@ -0,0 +1,92 @@
+#ifndef WINDOWEDSTATS_H
+#define WINDOWEDSTATS_H
+
+#include <vector>
+#include <geometry_msgs/Pose2D.h>
+
+/**
+ * Running statistics over the last N poses.  Samples go into a ring buffer and
+ * the sums are updated as samples enter and leave the window, so adding a
+ * sample and reading the mean/variance costs the same no matter how big the
+ * window is.  Headings are averaged on the circle (sin/cos sums) so they do
+ * not break when they wrap around +-PI.
+ *
+ * Optional extras:
+ *  - exponential weighting: each step back in the window multiplies a
+ *    sample's weight by decay (1.0 means a plain average)
+ *  - outlier rejection: once minSamples are in, a new sample further than
+ *    sigmas standard deviations (and at least minDistance meters) from the
+ *    current mean is refused
+ */
+class WindowedStats
+{
+public:
+    WindowedStats(unsigned int capacity);
+
+    void setDecay(double decay);
+    void setOutlierRejection(double sigmas, unsigned int minSamples, double minDistance);
+
+    // returns false if the sample was rejected as an outlier
+    bool add(double x, double y, double theta);
+    bool add(geometry_msgs::Pose2D pose) { return add(pose.x, pose.y, pose.theta); }
+
+    void clear();
+
+    unsigned int count() const { return size; }
+    unsigned int getCapacity() const { return capacity; }
+    bool full() const { return size == capacity; }
+    unsigned int getRejectedCount() const { return rejected; }
+
+    double meanX() const;
+    double meanY() const;
+    double meanTheta() const;               // circular mean of the headings
+    geometry_msgs::Pose2D mean() const;
+
+    double varianceX() const;
+    double varianceY() const;
+
+    // RMS distance of the samples from the mean position, in meters
+    double spread() const;
+
+    // standard error of the mean position, shrinks as samples agree and pile up
+    double standardError() const;
+
+    // 0 when headings point everywhere, 1 when they all agree
+    double headingConcentration() const;
+
+private:
+    struct Sample {
+        double x;
+        double y;
+        double sinTheta;
+        double cosTheta;
+    };
+
+    void resync();
+
+    std::vector<Sample> window;
+    unsigned int capacity;
+    unsigned int head;                      // next slot to write
+    unsigned int size;
+    unsigned int addsSinceResync;
+    unsigned int rejected;
+
+    double decay;
+    double decayToCapacity;                 // decay^capacity, weight of the sample leaving the window
+
+    double outlierSigmas;                   // 0 disables rejection
+    unsigned int outlierMinSamples;
+    double outlierMinDistance;
+
+    //weighted sums over the window
+    double weight;
+    double weightSquared;
+    double sumX;
+    double sumY;
+    double sumXX;
+    double sumYY;
+    double sumSin;
+    double sumCos;
+};
+
+#endif // WINDOWEDSTATS_H
@@ -0,0 +1,61 @@
+//Prints an event log written by the mobility node (~event_log) as the
+//infoLog lines it stands for, every event including the ones /infoLog
+//folded away or rate limited.
+//
+//  mobility_events <event log> [-r]
+//      -r   times relative to the first event instead of ros time
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+
+#include "EventLog.h"
+
+using namespace std;
+
+int main(int argc, char **argv)
+{
+    string path;
+    bool relative = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-r") == 0) { relative = true; }
+        else { path = argv[i]; }
+    }
+
+    if (path.empty())
+    {
+        cerr << "usage: " << argv[0] << " <event log> [-r]" << endl;
+        return EXIT_FAILURE;
+    }
+
+    EventLogReader reader;
+    if (!reader.open(path))
+    {
+        cerr << "Could not read event log " << path << endl;
+        return EXIT_FAILURE;
+    }
+
+    Event event;
+    unsigned long events = 0;
+    double firstTime = -1;
+
+    cout << fixed << setprecision(3);
+
+    while (reader.next(event))
+    {
+        if (firstTime < 0) { firstTime = event.time; }
+
+        cout << (relative ? event.time - firstTime : event.time) << " [" << (int)event.source << "] "
+             << formatEvent(event) << endl;
+
+        events++;
+    }
+
+    cerr << "Read " << events << " events" << endl;
+
+    return EXIT_SUCCESS;
+}
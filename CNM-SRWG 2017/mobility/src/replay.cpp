@@ -0,0 +1,171 @@
+//Plays a log written by the mobility node (~record_inputs) back through
+//MobilityCore as fast as the CPU allows.  Time comes from the log, so the run
+//goes exactly as it did on the rover and two builds can be compared by
+//diffing what this prints.  Every delivery is printed split into its phases
+//and the per phase times summed up at the end.
+//
+//  mobility_replay <input log> [-d] [-t]
+//      -d   also print every drive/gripper command
+//      -t   also print every state machine transition and what it cost
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cstring>
+#include <ctime>
+
+#include "MobilityCore.h"
+#include "InputLog.h"
+
+using namespace std;
+
+// prints the transitions a machine made since the last call
+static void printTransitions(const char* machineName, const HierarchicalStateMachine<MobilityCore>& machine, unsigned long& seen, double firstTime)
+{
+    unsigned long count = machine.getTransitionCount();
+    if (count == seen) { return; }
+
+    vector<TransitionRecord> trace = machine.getTrace();
+    unsigned long fresh = count - seen;
+    if (fresh > trace.size()) { fresh = trace.size(); }
+
+    for (unsigned long i = trace.size() - fresh; i < trace.size(); i++)
+    {
+        cout << trace[i].time - firstTime << " transition " << machineName << " " << machine.getName(trace[i].from)
+             << " -> " << machine.getName(trace[i].to) << " (" << trace[i].cost * 1e6 << " us)" << endl;
+    }
+
+    seen = count;
+}
+
+static double wallSeconds()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv)
+{
+    string path;
+    bool printCommands = false;
+    bool printTransitionTrace = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-d") == 0) { printCommands = true; }
+        else if (strcmp(argv[i], "-t") == 0) { printTransitionTrace = true; }
+        else { path = argv[i]; }
+    }
+
+    if (path.empty())
+    {
+        cerr << "usage: " << argv[0] << " <input log> [-d] [-t]" << endl;
+        return EXIT_FAILURE;
+    }
+
+    InputLogReader reader;
+    if (!reader.open(path))
+    {
+        cerr << "Could not read input log " << path << endl;
+        return EXIT_FAILURE;
+    }
+
+    MobilityCore core;
+    MobilityInput input;
+    string prevStateMachine;
+
+    unsigned long steps = 0;
+    unsigned long driveCommands = 0;
+    unsigned long mobilityTransitions = 0;
+    unsigned long reverseTransitions = 0;
+    CycleStats cycles(1000);
+    double firstTime = -1;
+    double lastTime = 0;
+
+    cout << fixed << setprecision(3);
+
+    double wallStart = wallSeconds();
+
+    while (reader.next(input))
+    {
+        if (firstTime < 0) { firstTime = input.time; }
+        lastTime = input.time;
+
+        const MobilityOutput& output = core.step(input);
+        steps++;
+        driveCommands += output.drive.size();
+
+        double t = input.time - firstTime;
+
+        for (unsigned int i = 0; i < output.events.size(); i++)
+        {
+            cout << t << " log " << formatEvent(output.events[i]) << endl;
+        }
+
+        if (output.hasCycle)
+        {
+            cycles.add(output.cycle);
+
+            cout << t << " cycle " << output.cycle.number << " " << output.cycle.total() << " s";
+            for (int phase = 0; phase < CYCLE_PHASES; phase++)
+            {
+                cout << " " << cyclePhaseName(phase) << " " << output.cycle.phaseSeconds[phase];
+            }
+            cout << endl;
+        }
+
+        // only print the state when it changes, like the node publishes it
+        if (output.hasStateName && output.stateName != prevStateMachine)
+        {
+            cout << t << " state " << output.stateName << endl;
+            prevStateMachine = output.stateName;
+        }
+
+        if (printTransitionTrace)
+        {
+            printTransitions("mobility", core.getMobilityMachine(), mobilityTransitions, firstTime);
+            printTransitions("reverse", core.getReverseMachine(), reverseTransitions, firstTime);
+        }
+
+        if (printCommands)
+        {
+            for (unsigned int i = 0; i < output.drive.size(); i++)
+            {
+                cout << t << " drive " << output.drive[i].linear << " " << output.drive[i].angular << endl;
+            }
+
+            for (unsigned int i = 0; i < output.fingerAngles.size(); i++)
+            {
+                cout << t << " finger " << output.fingerAngles[i] << endl;
+            }
+
+            for (unsigned int i = 0; i < output.wristAngles.size(); i++)
+            {
+                cout << t << " wrist " << output.wristAngles[i] << endl;
+            }
+        }
+    }
+
+    double wallElapsed = wallSeconds() - wallStart;
+
+    // summary goes to stderr so stdout stays diffable between runs
+    cerr << "Replayed " << steps << " inputs covering " << (firstTime < 0 ? 0 : lastTime - firstTime)
+         << " s in " << wallElapsed << " s, " << driveCommands << " drive commands" << endl;
+
+    cerr << "Transitions: " << core.getMobilityMachine().getTransitionCount() << " mobility ("
+         << core.getMobilityMachine().getTotalCost() * 1e6 << " us), " << core.getReverseMachine().getTransitionCount()
+         << " reverse (" << core.getReverseMachine().getTotalCost() * 1e6 << " us)" << endl;
+
+    if (cycles.count() > 0)
+    {
+        cerr << "Deliveries: " << cycles.count() << endl;
+        for (int phase = 0; phase <= CYCLE_PHASES; phase++)
+        {
+            cerr << "  " << setw(10) << left << cyclePhaseName(phase) << right << " mean " << cycles.mean(phase)
+                 << " s, p50 " << cycles.percentile(phase, 0.5) << " s, p95 " << cycles.percentile(phase, 0.95) << " s" << endl;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
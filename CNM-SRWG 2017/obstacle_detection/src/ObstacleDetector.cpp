@@ -0,0 +1,39 @@
+#include "ObstacleDetector.h"
+
+#include <std_msgs/UInt8.h>
+
+using namespace std;
+
+ObstacleDetector::ObstacleDetector(ros::NodeHandle& nh, const string& publishedName) : sonarSync(SonarSyncPolicy(10)) {
+    collisionDistance = 0.6;
+
+    obstaclePublish = nh.advertise<std_msgs::UInt8>((publishedName + "/obstacle"), 10);
+
+    sonarLeftSubscriber.subscribe(nh, (publishedName + "/sonarLeft"), 10);
+    sonarCenterSubscriber.subscribe(nh, (publishedName + "/sonarCenter"), 10);
+    sonarRightSubscriber.subscribe(nh, (publishedName + "/sonarRight"), 10);
+
+    sonarSync.connectInput(sonarLeftSubscriber, sonarCenterSubscriber, sonarRightSubscriber);
+    sonarSync.registerCallback(boost::bind(&ObstacleDetector::sonarHandler, this, _1, _2, _3));
+}
+
+void ObstacleDetector::sonarHandler(const sensor_msgs::Range::ConstPtr& sonarLeft, const sensor_msgs::Range::ConstPtr& sonarCenter, const sensor_msgs::Range::ConstPtr& sonarRight) {
+    //a new message every time, subscribers in the same process keep the pointer
+    std_msgs::UInt8Ptr obstacleMode(new std_msgs::UInt8);
+
+    if ((sonarLeft->range > collisionDistance) && (sonarCenter->range > collisionDistance) && (sonarRight->range > collisionDistance)) {
+        obstacleMode->data = 0; //no collision
+    }
+    else if ((sonarLeft->range > collisionDistance) && (sonarRight->range < collisionDistance)) {
+        obstacleMode->data = 1; //collision on right side
+    }
+    else {
+        obstacleMode->data = 2; //collision in front or on left side
+    }
+    if (sonarCenter->range < 0.12) //block in front of center unltrasound.
+    {
+        obstacleMode->data = 4;
+    }
+
+    obstaclePublish.publish(obstacleMode);
+}
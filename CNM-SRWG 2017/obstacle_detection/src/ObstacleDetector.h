@@ -0,0 +1,44 @@
+#ifndef OBSTACLEDETECTOR_H
+#define OBSTACLEDETECTOR_H
+
+#include <string>
+
+#include <ros/ros.h>
+
+//ROS libraries
+#include <message_filters/subscriber.h>
+#include <message_filters/synchronizer.h>
+#include <message_filters/sync_policies/approximate_time.h>
+
+//ROS messages
+#include <sensor_msgs/Range.h>
+
+/**
+ * Turns the left, center and right sonar ranges into the <name>/obstacle
+ * code mobility acts on: 0 nothing, 1 right, 2 front/left, 4 a block in
+ * front of the center sonar.
+ *
+ * Used by the obstacle executable and by ObstacleNodelet.  Every code goes
+ * out as its own shared pointer, so a subscriber in the same nodelet
+ * manager gets it without serialization.
+ */
+class ObstacleDetector {
+public:
+    ObstacleDetector(ros::NodeHandle& nh, const std::string& publishedName);
+
+private:
+    void sonarHandler(const sensor_msgs::Range::ConstPtr& sonarLeft, const sensor_msgs::Range::ConstPtr& sonarCenter, const sensor_msgs::Range::ConstPtr& sonarRight);
+
+    typedef message_filters::sync_policies::ApproximateTime<sensor_msgs::Range, sensor_msgs::Range, sensor_msgs::Range> SonarSyncPolicy;
+
+    double collisionDistance;                   //meters the ultrasonic detectors will flag obstacles
+
+    ros::Publisher obstaclePublish;
+
+    message_filters::Subscriber<sensor_msgs::Range> sonarLeftSubscriber;
+    message_filters::Subscriber<sensor_msgs::Range> sonarCenterSubscriber;
+    message_filters::Subscriber<sensor_msgs::Range> sonarRightSubscriber;
+    message_filters::Synchronizer<SonarSyncPolicy> sonarSync;
+};
+
+#endif // OBSTACLEDETECTOR_H
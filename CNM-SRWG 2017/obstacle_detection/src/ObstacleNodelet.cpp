@@ -0,0 +1,53 @@
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <unistd.h>
+
+#include "ObstacleDetector.h"
+
+using namespace std;
+
+namespace obstacle_detection {
+
+/**
+ * ObstacleDetector loaded into a nodelet manager, next to the mobility
+ * nodelet /obstacle goes to.  The rover name is the first nodelet argument
+ * and defaults to the hostname.
+ *
+ * ~realtime is not supported here: the sonar callbacks run on the manager's
+ * worker threads, which are shared with every other nodelet.
+ */
+class ObstacleNodelet : public nodelet::Nodelet {
+public:
+    ObstacleNodelet() : detector(NULL) {}
+    ~ObstacleNodelet() { delete detector; }
+
+private:
+    virtual void onInit() {
+        string publishedName;
+
+        const nodelet::V_string& argv = getMyArgv();
+        if (!argv.empty()) {
+            publishedName = argv[0];
+        } else {
+            char host[128];
+            gethostname(host, sizeof(host));
+            publishedName = host;
+        }
+
+        bool realTime;
+        getPrivateNodeHandle().param("realtime", realTime, false);
+        if (realTime) {
+            NODELET_WARN("~realtime is ignored in the obstacle nodelet, run the obstacle executable for it");
+        }
+
+        NODELET_INFO("Obstacle nodelet started for %s", publishedName.c_str());
+
+        detector = new ObstacleDetector(getNodeHandle(), publishedName);
+    }
+
+    ObstacleDetector* detector;
+};
+
+}
+
+PLUGINLIB_EXPORT_CLASS(obstacle_detection::ObstacleNodelet, nodelet::Nodelet)
@@ -1,27 +1,17 @@
 #include <ros/ros.h>
 
-//ROS libraries
-#include <message_filters/subscriber.h>
-#include <message_filters/synchronizer.h>
-#include <message_filters/sync_policies/approximate_time.h>
+//Sonar ranges -> /obstacle (also loaded as a nodelet, see ObstacleNodelet.cpp)
+#include "ObstacleDetector.h"
 
-//ROS messages
-#include <std_msgs/UInt8.h>
-#include <sensor_msgs/Range.h>
+//Real time scheduling (from mobility)
+#include <mobility/RealTime.h>
 
 using namespace std;
 
 //Globals
-double collisionDistance = 0.6; //meters the ultrasonic detectors will flag obstacles
 string publishedName;
 char host[128];
 
-//Publishers
-ros::Publisher obstaclePublish;
-
-//Callback handlers
-void sonarHandler(const sensor_msgs::Range::ConstPtr& sonarLeft, const sensor_msgs::Range::ConstPtr& sonarCenter, const sensor_msgs::Range::ConstPtr& sonarRight);
-
 int main(int argc, char** argv) {
     gethostname(host, sizeof (host));
     string hostname(host);
@@ -36,40 +26,31 @@ int main(int argc, char** argv) {
 
     ros::init(argc, argv, (publishedName + "_OBSTACLE"));
     ros::NodeHandle oNH;
-    
-    obstaclePublish = oNH.advertise<std_msgs::UInt8>((publishedName + "/obstacle"), 10);
-    
-    message_filters::Subscriber<sensor_msgs::Range> sonarLeftSubscriber(oNH, (publishedName + "/sonarLeft"), 10);
-    message_filters::Subscriber<sensor_msgs::Range> sonarCenterSubscriber(oNH, (publishedName + "/sonarCenter"), 10);
-    message_filters::Subscriber<sensor_msgs::Range> sonarRightSubscriber(oNH, (publishedName + "/sonarRight"), 10);
-
-    typedef message_filters::sync_policies::ApproximateTime<sensor_msgs::Range, sensor_msgs::Range, sensor_msgs::Range> sonarSyncPolicy;
 
-    message_filters::Synchronizer<sonarSyncPolicy> sonarSync(sonarSyncPolicy(10), sonarLeftSubscriber, sonarCenterSubscriber, sonarRightSubscriber);
-    sonarSync.registerCallback(boost::bind(&sonarHandler, _1, _2, _3));
+    ObstacleDetector detector(oNH, publishedName);
+
+    //Opt in: sonar callbacks run on this thread, ROS networking stays on its own threads at normal priority
+    ros::NodeHandle privateNH("~");
+    bool realTime;
+    RealTimeConfig realTimeConfig;
+    privateNH.param("realtime", realTime, false);
+    privateNH.param("realtime_priority", realTimeConfig.priority, realTimeConfig.priority);
+    privateNH.param("realtime_cpu", realTimeConfig.cpu, realTimeConfig.cpu);
+
+    if (realTime) {
+        string error;
+        if (!lockProcessMemory(error)) {
+            ROS_WARN("Could not lock the obstacle node in memory (%s)", error.c_str());
+        }
+
+        if (makeThreadRealTime(realTimeConfig, error)) {
+            ROS_INFO("Obstacle node running SCHED_FIFO at priority %d", realTimeConfig.priority);
+        } else {
+            ROS_WARN("Could not make the obstacle node real time (%s)", error.c_str());
+        }
+    }
 
     ros::spin();
 
     return EXIT_SUCCESS;
 }
-
-void sonarHandler(const sensor_msgs::Range::ConstPtr& sonarLeft, const sensor_msgs::Range::ConstPtr& sonarCenter, const sensor_msgs::Range::ConstPtr& sonarRight) {
-	std_msgs::UInt8 obstacleMode;
-	
-	if ((sonarLeft->range > collisionDistance) && (sonarCenter->range > collisionDistance) && (sonarRight->range > collisionDistance)) {
-		obstacleMode.data = 0; //no collision
-	}
-	else if ((sonarLeft->range > collisionDistance) && (sonarRight->range < collisionDistance)) {
-		obstacleMode.data = 1; //collision on right side
-	}
-	else {
-		obstacleMode.data = 2; //collision in front or on left side
-	}
-	if (sonarCenter->range < 0.12) //block in front of center unltrasound.
-	{
-		obstacleMode.data = 4;
-	}
-	
-        obstaclePublish.publish(obstacleMode);
-}
-